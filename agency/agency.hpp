@@ -25,6 +25,7 @@
 #include <agency/functional.hpp>
 #include <agency/future.hpp>
 #include <agency/shared.hpp>
+#include <agency/topology.hpp>
 #include <agency/version.hpp>
 
 /// \namespace agency
@@ -1,4 +1,5 @@
 #include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/arrive_and_wait.hpp>
 
 
 namespace agency
@@ -48,6 +49,17 @@ class heterogeneous_barrier
 #endif
     }
 
+    __agency_exec_check_disable__
+    __AGENCY_ANNOTATION
+    void arrive_and_wait(std::size_t index)
+    {
+#ifndef __CUDA_ARCH__
+      agency::detail::arrive_and_wait(host_barrier_, index);
+#else
+      agency::detail::arrive_and_wait(device_barrier_, index);
+#endif
+    }
+
   private:
 #ifndef __CUDA_ARCH__
     host_barrier_type host_barrier_;
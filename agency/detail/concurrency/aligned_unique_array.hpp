@@ -0,0 +1,90 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// aligned_array_deleter destroys the elements of an array created by make_aligned_unique_array()
+// and frees the array's storage
+template<class T>
+class aligned_array_deleter
+{
+  public:
+    aligned_array_deleter()
+      : storage_(nullptr),
+        size_(0)
+    {}
+
+    aligned_array_deleter(void* storage, size_t size)
+      : storage_(storage),
+        size_(size)
+    {}
+
+    void operator()(T* ptr) const
+    {
+      for(size_t i = size_; i > 0; --i)
+      {
+        ptr[i-1].~T();
+      }
+
+      std::free(storage_);
+    }
+
+  private:
+    void* storage_;
+    size_t size_;
+};
+
+
+template<class T>
+using aligned_unique_array = std::unique_ptr<T[], aligned_array_deleter<T>>;
+
+
+// make_aligned_unique_array() value-initializes an array of n objects of type T whose storage is aligned to alignof(T)
+// before C++17, new[] does not respect alignments greater than alignof(std::max_align_t), such as the cache line alignment
+// of types which are padded to prevent false sharing
+template<class T>
+aligned_unique_array<T> make_aligned_unique_array(size_t n)
+{
+  // allocate enough extra space to align the first element
+  void* storage = std::malloc(n * sizeof(T) + alignof(T) - 1);
+  if(!storage)
+  {
+    throw std::bad_alloc();
+  }
+
+  std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage);
+  address = (address + alignof(T) - 1) & ~static_cast<std::uintptr_t>(alignof(T) - 1);
+  T* ptr = reinterpret_cast<T*>(address);
+
+  size_t i = 0;
+  try
+  {
+    for(; i < n; ++i)
+    {
+      ::new(ptr + i) T();
+    }
+  }
+  catch(...)
+  {
+    aligned_array_deleter<T>(storage, i)(ptr);
+    throw;
+  }
+
+  return aligned_unique_array<T>(ptr, aligned_array_deleter<T>(storage, n));
+}
+
+
+} // end detail
+} // end agency
+
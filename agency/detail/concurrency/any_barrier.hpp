@@ -2,6 +2,7 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/concurrency/barrier.hpp>
+#include <agency/detail/concurrency/arrive_and_wait.hpp>
 #include <agency/cuda/detail/concurrency/block_barrier.hpp>
 #include <agency/cuda/detail/concurrency/grid_barrier.hpp>
 #include <agency/cuda/detail/concurrency/heterogeneous_barrier.hpp>
@@ -128,6 +129,12 @@ class any_barrier
       implementation_.arrive_and_wait();
     }
 
+    __AGENCY_ANNOTATION
+    void arrive_and_wait(std::size_t index)
+    {
+      detail::arrive_and_wait(implementation_, index);
+    }
+
     // XXX this function should be eliminated when shared_param_type's move constructor is eliminated pending C++17
     //     see wg21.link/P0135
     __AGENCY_ANNOTATION
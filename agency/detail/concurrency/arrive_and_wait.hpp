@@ -0,0 +1,50 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <cstddef>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+template<class Barrier>
+using indexed_arrive_and_wait_t = decltype(std::declval<Barrier&>().arrive_and_wait(std::declval<std::size_t>()));
+
+// some barriers, such as tree_barrier, synchronize faster when each arriving agent identifies itself
+template<class Barrier>
+using has_indexed_arrive_and_wait = is_detected<indexed_arrive_and_wait_t, Barrier>;
+
+
+// arrive_and_wait(barrier, index) arrives at the barrier on behalf of the agent with the given index
+// index should be distinct among the agents which synchronize with the barrier, and less than barrier.count()
+// barriers which do not use the index ignore it
+__agency_exec_check_disable__
+template<class Barrier,
+         __AGENCY_REQUIRES(has_indexed_arrive_and_wait<Barrier>::value)
+        >
+__AGENCY_ANNOTATION
+void arrive_and_wait(Barrier& barrier, std::size_t index)
+{
+  barrier.arrive_and_wait(index);
+}
+
+__agency_exec_check_disable__
+template<class Barrier,
+         __AGENCY_REQUIRES(!has_indexed_arrive_and_wait<Barrier>::value)
+        >
+__AGENCY_ANNOTATION
+void arrive_and_wait(Barrier& barrier, std::size_t)
+{
+  barrier.arrive_and_wait();
+}
+
+
+} // end detail
+} // end agency
+
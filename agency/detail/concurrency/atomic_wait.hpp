@@ -0,0 +1,191 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__cpp_lib_atomic_wait)
+#define __AGENCY_HAS_STD_ATOMIC_WAIT
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define __AGENCY_HAS_FUTEX
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+namespace atomic_wait_detail
+{
+
+
+#if defined(__AGENCY_HAS_FUTEX)
+
+// a futex operates on an int-sized word
+template<class T>
+struct is_futex_word
+  : std::integral_constant<
+      bool,
+      sizeof(std::atomic<T>) == sizeof(int) && (std::is_integral<T>::value || std::is_enum<T>::value)
+    >
+{};
+
+// blocks while the word at address equals expected
+// the kernel compares the word and sleeps atomically, so a wake after the word changes is never lost
+inline void futex_wait(const void* address, int expected)
+{
+  ::syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+inline void futex_wake(const void* address, int num_threads)
+{
+  ::syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, num_threads, nullptr, nullptr, 0);
+}
+
+template<class T>
+int to_futex_word(const T& value)
+{
+  int result;
+  std::memcpy(&result, &value, sizeof(int));
+  return result;
+}
+
+#else
+
+template<class T>
+struct is_futex_word : std::false_type {};
+
+#endif
+
+
+// atomics which cannot wait any other way wait on one of a fixed set of condition variables, chosen by address
+// because unrelated atomics may share a condition variable, every notification wakes all of its waiters
+struct parking_slot
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+inline parking_slot& parking_slot_for(const void* address)
+{
+  static parking_slot slots[64];
+  return slots[(reinterpret_cast<std::uintptr_t>(address) / sizeof(void*)) % 64];
+}
+
+template<class T>
+void park(const std::atomic<T>& a, T old, std::memory_order order)
+{
+  parking_slot& slot = parking_slot_for(&a);
+
+  std::unique_lock<std::mutex> lock(slot.mutex);
+  while(a.load(order) == old)
+  {
+    slot.cv.wait(lock);
+  }
+}
+
+inline void unpark_all(const void* address)
+{
+  parking_slot& slot = parking_slot_for(address);
+
+  // synchronize with a waiter which has compared the atomic's value, but not yet begun to wait
+  {
+    std::lock_guard<std::mutex> lock(slot.mutex);
+  }
+
+  slot.cv.notify_all();
+}
+
+
+} // end atomic_wait_detail
+
+
+// atomic_wait(a, old) blocks until a's value differs from old
+// it is the C++20 member function std::atomic<T>::wait() when the standard library provides it,
+// a futex when T is int-sized on Linux, and a condition variable otherwise
+//
+// the thread which changes a's value must call atomic_notify_one(a) or atomic_notify_all(a) afterward
+// notification is costly even when nothing waits, so callers which notify often should count their waiters
+template<class T>
+void atomic_wait(const std::atomic<T>& a, T old, std::memory_order order = std::memory_order_seq_cst)
+{
+#if defined(__AGENCY_HAS_STD_ATOMIC_WAIT)
+  while(a.load(order) == old)
+  {
+    a.wait(old, order);
+  }
+#else
+  if(atomic_wait_detail::is_futex_word<T>::value)
+  {
+#if defined(__AGENCY_HAS_FUTEX)
+    while(a.load(order) == old)
+    {
+      atomic_wait_detail::futex_wait(&a, atomic_wait_detail::to_futex_word(old));
+    }
+#endif
+  }
+  else
+  {
+    atomic_wait_detail::park(a, old, order);
+  }
+#endif
+}
+
+
+// wakes at least one of the threads blocked in atomic_wait(a, ...)
+template<class T>
+void atomic_notify_one(std::atomic<T>& a)
+{
+#if defined(__AGENCY_HAS_STD_ATOMIC_WAIT)
+  a.notify_one();
+#else
+  if(atomic_wait_detail::is_futex_word<T>::value)
+  {
+#if defined(__AGENCY_HAS_FUTEX)
+    atomic_wait_detail::futex_wake(&a, 1);
+#endif
+  }
+  else
+  {
+    atomic_wait_detail::unpark_all(&a);
+  }
+#endif
+}
+
+
+// wakes every thread blocked in atomic_wait(a, ...)
+template<class T>
+void atomic_notify_all(std::atomic<T>& a)
+{
+#if defined(__AGENCY_HAS_STD_ATOMIC_WAIT)
+  a.notify_all();
+#else
+  if(atomic_wait_detail::is_futex_word<T>::value)
+  {
+#if defined(__AGENCY_HAS_FUTEX)
+    atomic_wait_detail::futex_wake(&a, INT_MAX);
+#endif
+  }
+  else
+  {
+    atomic_wait_detail::unpark_all(&a);
+  }
+#endif
+}
+
+
+} // end detail
+} // end agency
+
+#undef __AGENCY_HAS_STD_ATOMIC_WAIT
+#undef __AGENCY_HAS_FUTEX
+
@@ -1,12 +1,19 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/this_fiber.hpp>
+#include <agency/detail/concurrency/spin_wait.hpp>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/aligned_unique_array.hpp>
 
 #include <functional>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
 
 namespace agency
 {
@@ -66,6 +73,17 @@ class blocking_barrier
         // unblock all blocking threads
         cv_.notify_all();
       }
+      else if(this_fiber::is_fiber())
+      {
+        // a fiber must not block its thread, because the fibers it waits on may need that thread to arrive
+        size_t old_generation = generation_;
+        while(generation_ == old_generation)
+        {
+          lock.unlock();
+          this_fiber::yield();
+          lock.lock();
+        }
+      }
       else
       {
         // block until either we are woken or the generation changes
@@ -122,9 +140,12 @@ class spinning_barrier
       }
       else
       {
+        bool is_fiber = this_fiber::is_fiber();
+
         while(generation_.load() == generation)
         {
-          ;
+          // a fiber must not spin on its thread, because the fibers it waits on may need that thread to arrive
+          if(is_fiber) this_fiber::yield();
         }
       }
     }
@@ -136,7 +157,218 @@ protected:
 };
 
 
-using barrier = blocking_barrier;
+// tree_barrier is a combining tree barrier
+//
+// Each agent arrives at one of the tree's leaves, and the final agent to arrive at a node continues on to the node's parent.
+// At most radix agents contend for any node, and the final agent to arrive at the barrier reaches the root after
+// O(log(count)) steps rather than after O(count) steps.
+//
+// Agents waiting for the final arrival spin briefly and then block.
+//
+// arrive_and_wait(index) requires each of the count agents to arrive with a distinct index in [0, count).
+// arrive_and_wait() chooses an index for the caller, at the cost of an atomic operation on a counter shared by every agent.
+// Within a single phase, either every agent should pass an index to arrive_and_wait() or arrive_and_drop(), or no agent should.
+class tree_barrier
+{
+  public:
+    static constexpr size_t radix = 4;
+
+    inline explicit tree_barrier(size_t num_threads)
+      : count_(num_threads),
+        num_nodes_(0),
+        next_index_(0),
+        generation_(0),
+        num_sleeping_(0)
+    {
+      if(num_threads == 0) throw std::invalid_argument("barrier: num_threads may not be 0.");
+
+      // count the nodes beneath the root
+      for(size_t level_size = ceil_div(count_, radix); level_size > 1; level_size = ceil_div(level_size, radix))
+      {
+        num_nodes_ += level_size;
+      }
+
+      if(num_nodes_ > 0)
+      {
+        nodes_ = make_aligned_unique_array<padded_node>(num_nodes_);
+      }
+
+      // initialize each level of nodes from the leaves up
+      // the parent of the topmost level beneath the root is the node with index num_nodes_, which is the root
+      size_t level_begin = 0;
+      size_t num_children = count_;
+      for(size_t level_size = ceil_div(count_, radix); level_size > 1; level_size = ceil_div(level_size, radix))
+      {
+        size_t parent_level_begin = level_begin + level_size;
+
+        for(size_t i = 0; i < level_size; ++i)
+        {
+          // the final node of a level may have fewer than radix children
+          initialize(nodes_[level_begin + i], std::min(size_t(radix), num_children - i * radix), parent_level_begin + i / radix);
+        }
+
+        level_begin = parent_level_begin;
+        num_children = level_size;
+      }
+
+      initialize(root_, num_children, num_nodes_);
+    }
+
+    // define this to workaround nvcc's automatic execution space deduction for compiler-generated functions
+    inline ~tree_barrier() {}
+
+    inline size_t count() const
+    {
+      return count_;
+    }
+
+    // like blocking_barrier::arrive_and_drop(), arrive_and_drop() arrives at the barrier without waiting for the other agents
+    // the caller still counts towards count() in later phases
+    inline void arrive_and_drop()
+    {
+      arrive_and_drop(take_index());
+    }
+
+    inline void arrive_and_drop(size_t index)
+    {
+      if(arrive(index))
+      {
+        release();
+      }
+    }
+
+    inline void arrive_and_wait()
+    {
+      arrive_and_wait(take_index());
+    }
+
+    inline void arrive_and_wait(size_t index)
+    {
+      unsigned int generation = generation_.load(std::memory_order_acquire);
+
+      if(arrive(index))
+      {
+        release();
+      }
+      else
+      {
+        wait_for_next_generation(generation);
+      }
+    }
+
+  private:
+    // the number of times an agent pauses before it blocks
+    static constexpr size_t max_num_spins = 128;
+
+    struct node
+    {
+      std::atomic<size_t> unarrived;
+      size_t count;
+      size_t parent;
+    };
+
+    // the nodes beneath the root each occupy their own cache line
+    struct alignas(64) padded_node : node {};
+
+    static size_t ceil_div(size_t numerator, size_t denominator)
+    {
+      return (numerator + denominator - 1) / denominator;
+    }
+
+    static void initialize(node& n, size_t count, size_t parent)
+    {
+      n.unarrived.store(count, std::memory_order_relaxed);
+      n.count = count;
+      n.parent = parent;
+    }
+
+    inline node& node_at(size_t i)
+    {
+      return i == num_nodes_ ? root_ : nodes_[i];
+    }
+
+    inline size_t take_index()
+    {
+      // every agent of a phase takes its index before the phase completes, so indices taken modulo count_ are distinct within each phase
+      return next_index_.fetch_add(1, std::memory_order_relaxed) % count_;
+    }
+
+    // called by the final arrival to begin the next phase and release the other agents
+    inline void release()
+    {
+      generation_.fetch_add(1);
+
+      if(num_sleeping_.load() > 0)
+      {
+        atomic_notify_all(generation_);
+      }
+    }
+
+    // returns true if the caller is the final agent to arrive at the root
+    inline bool arrive(size_t index)
+    {
+      node* n = &node_at(std::min(index / radix, num_nodes_));
+
+      // climb the tree for as long as we are the final arrival at a node
+      while(n->unarrived.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        // reset the node for the next phase
+        // no agent arrives at this node again until the generation changes
+        n->unarrived.store(n->count, std::memory_order_relaxed);
+
+        if(n == &root_) return true;
+
+        n = &node_at(n->parent);
+      }
+
+      return false;
+    }
+
+    inline void wait_for_next_generation(unsigned int generation)
+    {
+      if(this_fiber::is_fiber())
+      {
+        // a fiber must not block its thread, because the fibers it waits on may need that thread to arrive
+        while(generation_.load(std::memory_order_acquire) == generation)
+        {
+          this_fiber::yield();
+        }
+
+        return;
+      }
+
+      exponential_backoff backoff;
+      for(size_t i = 0; i < max_num_spins; ++i)
+      {
+        if(generation_.load(std::memory_order_acquire) != generation) return;
+
+        backoff.pause();
+      }
+
+      // announce that we are sleeping before we check the generation for the final time
+      // the final arrival changes the generation before it checks for sleeping agents, so either it notifies us or we notice the change
+      ++num_sleeping_;
+      atomic_wait(generation_, generation);
+      --num_sleeping_;
+    }
+
+    size_t                         count_;
+    size_t                         num_nodes_;
+    aligned_unique_array<padded_node> nodes_;
+
+    // root_ is not part of nodes_ so that small barriers need no allocation
+    // the padding keeps the root, the index counter, and the generation, which waiting agents read, on separate cache lines
+    // padding is used rather than alignas so that a tree_barrier may be stored in a variant_barrier
+    node                           root_;
+    char                           padding0_[64];
+    std::atomic<size_t>            next_index_;
+    char                           padding1_[64];
+    std::atomic<unsigned int>      generation_;
+    std::atomic<size_t>            num_sleeping_;
+};
+
+
+using barrier = tree_barrier;
 
 
 } // end detail
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/concurrent_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// bounded_concurrent_queue is a lock-free, multi-producer, multi-consumer queue with a fixed capacity
+//
+// Items live in a ring buffer of cells. Each cell carries a sequence number which tells producers and
+// consumers whether the cell is ready to be written or read, so neither emplace() nor wait_and_pop()
+// takes a lock while the queue is neither empty nor full. This is Dmitry Vyukov's bounded MPMC queue.
+//
+// Threads which find the queue empty (or full) spin briefly and then park on a condition variable.
+// The opposite side takes the lock only to wake parked threads, and only when some thread is parked.
+//
+// Unlike the other concurrent queues, wait_and_pop() continues to return items after close(), until the queue is empty.
+template<class T>
+class bounded_concurrent_queue
+{
+  public:
+    static constexpr size_t default_capacity = 1024;
+
+    // capacity is rounded up to a power of two
+    explicit bounded_concurrent_queue(size_t capacity = default_capacity)
+      : mask_(round_up_to_power_of_two(capacity) - 1),
+        cells_(new cell[mask_ + 1]),
+        enqueue_position_(0),
+        dequeue_position_(0),
+        is_closed_(false),
+        num_poppers_(0),
+        num_parked_consumers_(0),
+        num_parked_producers_(0)
+    {
+      for(size_t i = 0; i <= mask_; ++i)
+      {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    ~bounded_concurrent_queue()
+    {
+      close();
+
+      // destroy the items which were never popped
+      for(size_t position = dequeue_position_.load(); position != enqueue_position_.load(); ++position)
+      {
+        cells_[position & mask_].item().~T();
+      }
+    }
+
+    size_t capacity() const
+    {
+      return mask_ + 1;
+    }
+
+    void close()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      // don't attempt to close a closed queue
+      if(is_closed_.load()) return;
+
+      is_closed_.store(true);
+
+      // wake everyone up
+      not_empty_.notify_all();
+      not_full_.notify_all();
+
+      // release the lock so that woken poppers may leave
+      lock.unlock();
+
+      // wait until all the poppers have finished with wait_and_pop()
+      // a popper's final access to this queue is to leave num_poppers_, so it cannot notify us afterward
+      // instead, we poll num_poppers_, sleeping briefly between looks
+      while(num_poppers_.load() != 0)
+      {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+
+    bool is_closed()
+    {
+      return is_closed_.load();
+    }
+
+    template<class... Args>
+    queue_status emplace(Args&&... args)
+    {
+      queue_status result = emplace_without_notification(std::forward<Args>(args)...);
+
+      if(result == queue_status::open_and_ready)
+      {
+        notify_consumers(1);
+      }
+
+      return result;
+    }
+
+    queue_status push(const T& item)
+    {
+      return emplace(item);
+    }
+
+    // moves each item in [first, last) into the queue, then wakes as many parked consumers as items at once
+    template<class Iterator>
+    queue_status emplace_n(Iterator first, Iterator last)
+    {
+      if(is_closed_.load())
+      {
+        return queue_status::closed;
+      }
+
+      size_t num_unnotified = 0;
+
+      for(; first != last; ++first, ++num_unnotified)
+      {
+        if(!try_emplace(std::move(*first)))
+        {
+          // the queue is full, so wake consumers for the items we have already enqueued before we park
+          notify_consumers(num_unnotified);
+          num_unnotified = 0;
+
+          if(emplace_without_notification(std::move(*first)) == queue_status::closed)
+          {
+            return queue_status::closed;
+          }
+        }
+      }
+
+      notify_consumers(num_unnotified);
+
+      return queue_status::open_and_ready;
+    }
+
+    // XXX this should return queue_status
+    bool wait_and_pop(T& item)
+    {
+      scope_bumper<int> popping(num_poppers_);
+
+      while(true)
+      {
+        if(spin_until([&]{ return try_pop(item); }))
+        {
+          notify_producers();
+          return true;
+        }
+
+        if(is_closed_.load())
+        {
+          return false;
+        }
+
+        // park until an item arrives or the queue closes
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        num_parked_consumers_.fetch_add(1);
+
+        // look once more after announcing that we are about to park
+        // a producer either observes our announcement and notifies us, or we observe its item
+        bool popped = try_pop(item);
+
+        if(!popped && !is_closed_.load())
+        {
+          not_empty_.wait(lock);
+        }
+
+        num_parked_consumers_.fetch_sub(1);
+
+        if(popped)
+        {
+          lock.unlock();
+          notify_producers();
+          return true;
+        }
+      }
+    }
+
+  private:
+    struct cell
+    {
+      std::atomic<size_t> sequence;
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+      T& item()
+      {
+        return *reinterpret_cast<T*>(&storage);
+      }
+    };
+
+    static size_t round_up_to_power_of_two(size_t n)
+    {
+      if(n < 2) return 2;
+
+      size_t result = 1;
+      while(result < n)
+      {
+        result *= 2;
+      }
+
+      return result;
+    }
+
+    template<class Predicate>
+    static bool spin_until(Predicate pred)
+    {
+      for(int i = 0; i < 64; ++i)
+      {
+        if(pred()) return true;
+      }
+
+      return false;
+    }
+
+    template<class... Args>
+    bool try_emplace(Args&&... args)
+    {
+      size_t position = enqueue_position_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        cell& c = cells_[position & mask_];
+        size_t sequence = c.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if(difference == 0)
+        {
+          // the cell is empty, so try to claim it
+          if(enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            ::new(&c.storage) T(std::forward<Args>(args)...);
+
+            // publish the item to consumers
+            c.sequence.store(position + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if(difference < 0)
+        {
+          // the cell still holds an item from the previous lap, so the queue is full
+          return false;
+        }
+        else
+        {
+          // another producer claimed this cell first
+          position = enqueue_position_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    bool try_pop(T& item)
+    {
+      size_t position = dequeue_position_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        cell& c = cells_[position & mask_];
+        size_t sequence = c.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if(difference == 0)
+        {
+          // the cell holds an item, so try to claim it
+          if(dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            item = std::move(c.item());
+            c.item().~T();
+
+            // release the cell to producers of the next lap
+            c.sequence.store(position + mask_ + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if(difference < 0)
+        {
+          // the cell has not been written yet, so the queue is empty
+          return false;
+        }
+        else
+        {
+          // another consumer claimed this cell first
+          position = dequeue_position_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    template<class... Args>
+    queue_status emplace_without_notification(Args&&... args)
+    {
+      while(true)
+      {
+        if(is_closed_.load())
+        {
+          return queue_status::closed;
+        }
+
+        if(spin_until([&]{ return try_emplace(std::forward<Args>(args)...); }))
+        {
+          return queue_status::open_and_ready;
+        }
+
+        // park until a consumer frees a cell or the queue closes
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        num_parked_producers_.fetch_add(1);
+
+        bool emplaced = try_emplace(std::forward<Args>(args)...);
+
+        if(!emplaced && !is_closed_.load())
+        {
+          not_full_.wait(lock);
+        }
+
+        num_parked_producers_.fetch_sub(1);
+
+        if(emplaced)
+        {
+          return queue_status::open_and_ready;
+        }
+      }
+    }
+
+    // wakes up to n parked consumers
+    void notify_consumers(size_t n)
+    {
+      // order our items before the load of num_parked_consumers_
+      // pairs with the fetch_add performed by a consumer about to park
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      size_t num_parked = num_parked_consumers_.load();
+
+      if(n > 0 && num_parked > 0)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(n >= num_parked)
+        {
+          not_empty_.notify_all();
+        }
+        else
+        {
+          for(size_t i = 0; i < n; ++i)
+          {
+            not_empty_.notify_one();
+          }
+        }
+      }
+    }
+
+    void notify_producers()
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if(num_parked_producers_.load() > 0)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        not_full_.notify_one();
+      }
+    }
+
+    const size_t mask_;
+    std::unique_ptr<cell[]> cells_;
+
+    // keep the producers' and consumers' positions on separate cache lines
+    alignas(64) std::atomic<size_t> enqueue_position_;
+    alignas(64) std::atomic<size_t> dequeue_position_;
+
+    alignas(64) std::atomic<bool> is_closed_;
+    std::atomic<int> num_poppers_;
+    std::atomic<size_t> num_parked_consumers_;
+    std::atomic<size_t> num_parked_producers_;
+
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/detail/concurrency/synchronic>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/spin_wait.hpp>
 
 #include <queue>
 #include <atomic>
+#include <mutex>
 #include <condition_variable>
 
 
@@ -37,7 +39,8 @@ struct scope_bumper
 template<class T>
 void wait_until_equal(const std::atomic<T>& a, const T& value)
 {
-  // implement this with a spin loop
+  // implement this with a spin loop rather than atomic_wait(), so that the threads which change a need not notify us
+  // this matters to the queues below, whose poppers' final access to the queue is to leave num_poppers_
   while(a != value)
   {
     // spin
@@ -53,17 +56,19 @@ enum queue_status
 };
 
 
+// atomic_wait_concurrent_queue's poppers spin briefly while the queue is empty and then block with atomic_wait()
 template<class T>
-class synchronic_concurrent_queue
+class atomic_wait_concurrent_queue
 {
   public:
-    synchronic_concurrent_queue()
+    atomic_wait_concurrent_queue()
       : num_poppers_(0),
+        num_sleeping_(0),
         status_(open_and_empty)
     {
     }
 
-    ~synchronic_concurrent_queue()
+    ~atomic_wait_concurrent_queue()
     {
       close();
     }
@@ -76,9 +81,11 @@ class synchronic_concurrent_queue
         // don't attempt to close a closed queue
         if(status_ == closed) return;
 
-        // notify that we're closing
-        notifier_.notify_all(status_, (int)closed);
+        status_.store(closed);
       }
+
+      // notify that we're closing
+      atomic_notify_all(status_);
       
       // wait until all the poppers have finished with wait_and_pop() 
       detail::wait_until_equal(num_poppers_, 0);
@@ -94,16 +101,20 @@ class synchronic_concurrent_queue
     template<class... Args>
     queue_status emplace(Args&&... args)
     {
-      std::unique_lock<std::mutex> lock(mutex_);
-
-      if(status_ == closed)
       {
-        return queue_status::closed;
-      }
+        std::unique_lock<std::mutex> lock(mutex_);
 
-      items_.emplace(std::forward<Args>(args)...);
+        if(status_ == closed)
+        {
+          return queue_status::closed;
+        }
 
-      notifier_.notify_one(status_, (int)open_and_ready); 
+        items_.emplace(std::forward<Args>(args)...);
+
+        status_.store(open_and_ready);
+      }
+
+      notify_one();
 
       return queue_status::open_and_ready;
     }
@@ -113,6 +124,39 @@ class synchronic_concurrent_queue
       return emplace(item);
     }
 
+    // moves each item in [first, last) into the queue, then notifies all waiting poppers once
+    template<class Iterator>
+    queue_status emplace_n(Iterator first, Iterator last)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if(status_ == closed)
+        {
+          return queue_status::closed;
+        }
+
+        if(first == last)
+        {
+          return queue_status::open_and_ready;
+        }
+
+        for(; first != last; ++first)
+        {
+          items_.emplace(std::move(*first));
+        }
+
+        status_.store(open_and_ready);
+      }
+
+      if(num_sleeping_.load() > 0)
+      {
+        atomic_notify_all(status_);
+      }
+
+      return queue_status::open_and_ready;
+    }
+
     // XXX this should return queue_status
     bool wait_and_pop(T& item)
     {
@@ -120,7 +164,9 @@ class synchronic_concurrent_queue
 
       while(true)
       {
-        notifier_.wait_for_change(status_, (int)open_and_empty);
+        wait_while_empty();
+
+        bool needs_notify = false;
 
         {
           std::unique_lock<std::mutex> lock(mutex_);
@@ -138,11 +184,28 @@ class synchronic_concurrent_queue
             item = std::move(items_.front());
             items_.pop();
 
-            notifier_.notify_one(status_, (int)(items_.empty() ? open_and_empty : open_and_ready));
-
-            return true;
+            if(items_.empty())
+            {
+              status_.store(open_and_empty);
+            }
+            else
+            {
+              needs_notify = true;
+            }
+          }
+          else
+          {
+            continue;
           }
         }
+
+        // pass the notification along to another popper
+        if(needs_notify)
+        {
+          notify_one();
+        }
+
+        return true;
       }
 
       return false;
@@ -156,16 +219,41 @@ class synchronic_concurrent_queue
       closed = 2
     };
 
+    // the number of times a popper pauses before it blocks
+    static constexpr size_t max_num_spins = 16;
+
+    void wait_while_empty()
+    {
+      exponential_backoff backoff;
+      for(size_t i = 0; i < max_num_spins; ++i)
+      {
+        if(status_.load() != open_and_empty) return;
+
+        backoff.pause();
+      }
+
+      // announce that we are sleeping before we check the status for the final time
+      // producers change the status before they check for sleeping poppers, so either we are notified or we notice the change
+      ++num_sleeping_;
+      atomic_wait(status_, static_cast<int>(open_and_empty));
+      --num_sleeping_;
+    }
+
+    void notify_one()
+    {
+      if(num_sleeping_.load() > 0)
+      {
+        atomic_notify_one(status_);
+      }
+    }
+
     std::queue<T> items_;
     std::mutex mutex_;
     std::atomic<int> num_poppers_;
+    std::atomic<int> num_sleeping_;
 
-    // XXX synchronic<status> doesn't seem to work correctly
-    //std::atomic<status> status_;
-    //std::experimental::synchronic<status, std::experimental::synchronic_option::optimize_for_long_wait> notifier_;
-
+    // status_ is an int rather than a status so that it is a futex word
     std::atomic<int> status_;
-    std::experimental::synchronic<int, std::experimental::synchronic_option::optimize_for_short_wait> notifier_;
 };
 
 
@@ -229,6 +317,29 @@ class condition_variable_concurrent_queue
       return emplace(item);
     }
 
+    // moves each item in [first, last) into the queue, then wakes all waiting poppers once
+    template<class Iterator>
+    queue_status emplace_n(Iterator first, Iterator last)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if(is_closed_)
+        {
+          return queue_status::closed;
+        }
+
+        for(; first != last; ++first)
+        {
+          items_.emplace(std::move(*first));
+        }
+      }
+
+      wake_up_.notify_all();
+
+      return queue_status::open_and_ready;
+    }
+
     // XXX this should return queue_status
     bool wait_and_pop(T& item)
     {
@@ -283,7 +394,7 @@ class condition_variable_concurrent_queue
 
 
 template<class T>
-using concurrent_queue = synchronic_concurrent_queue<T>;
+using concurrent_queue = atomic_wait_concurrent_queue<T>;
 
 
 } // end detail
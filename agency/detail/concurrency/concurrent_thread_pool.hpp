@@ -0,0 +1,191 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <agency/detail/type_traits.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// concurrent_thread_pool executes each submitted task on a thread of its own, so all
+// submitted tasks make progress concurrently, as concurrent execution agents require
+//
+// Unlike thread_pool, concurrent_thread_pool does not have a fixed number of threads.
+// When no thread is idle, a submission creates a new one. When a thread finishes its task,
+// it parks until it receives another. So, a program which repeatedly launches groups of
+// concurrent agents creates threads only until the pool grows to the size of its largest group.
+class concurrent_thread_pool
+{
+  private:
+    struct worker
+    {
+      worker()
+        : is_stopping(false)
+      {}
+
+      std::mutex mutex;
+      std::condition_variable wake_up;
+      unique_function<void()> task;
+      bool is_stopping;
+      std::thread thread;
+    };
+
+  public:
+    concurrent_thread_pool() = default;
+
+    ~concurrent_thread_pool()
+    {
+      std::vector<std::unique_ptr<worker>> workers;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        workers.swap(workers_);
+        idle_workers_.clear();
+      }
+
+      for(auto& w : workers)
+      {
+        {
+          std::lock_guard<std::mutex> lock(w->mutex);
+          w->is_stopping = true;
+        }
+
+        w->wake_up.notify_one();
+      }
+
+      for(auto& w : workers)
+      {
+        w->thread.join();
+      }
+    }
+
+    // executes f on a thread which is not executing any other task
+    template<class Function,
+             class = result_of_t<Function()>>
+    void submit(Function&& f)
+    {
+      assign(acquire_workers(1).front(), std::forward<Function>(f));
+    }
+
+    // executes f(i) for each i in [0, n), each on a different thread
+    template<class Function,
+             class = result_of_t<Function(size_t)>>
+    void bulk_submit(Function f, size_t n)
+    {
+      std::vector<worker*> workers = acquire_workers(n);
+
+      for(size_t i = 0; i < n; ++i)
+      {
+        assign(workers[i], [=]() mutable
+        {
+          f(i);
+        });
+      }
+    }
+
+    // returns the number of threads currently owned by this pool, whether busy or idle
+    size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return workers_.size();
+    }
+
+  private:
+    // returns n idle workers, creating new workers if too few are idle
+    std::vector<worker*> acquire_workers(size_t n)
+    {
+      std::vector<worker*> result;
+      result.reserve(n);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      while(result.size() < n && !idle_workers_.empty())
+      {
+        result.push_back(idle_workers_.back());
+        idle_workers_.pop_back();
+      }
+
+      while(result.size() < n)
+      {
+        workers_.emplace_back(new worker);
+        worker* w = workers_.back().get();
+
+        w->thread = std::thread([=]
+        {
+          work(w);
+        });
+
+        result.push_back(w);
+      }
+
+      return result;
+    }
+
+    template<class Function>
+    static void assign(worker* w, Function&& f)
+    {
+      {
+        std::lock_guard<std::mutex> lock(w->mutex);
+        w->task = std::forward<Function>(f);
+      }
+
+      w->wake_up.notify_one();
+    }
+
+    void work(worker* w)
+    {
+      std::unique_lock<std::mutex> lock(w->mutex);
+
+      while(true)
+      {
+        w->wake_up.wait(lock, [=]
+        {
+          return w->task || w->is_stopping;
+        });
+
+        if(!w->task) return;
+
+        {
+          unique_function<void()> task = std::move(w->task);
+          lock.unlock();
+
+          // destroy the task before parking, because its destruction may signal its completion
+          task();
+        }
+
+        {
+          std::lock_guard<std::mutex> pool_lock(mutex_);
+          idle_workers_.push_back(w);
+        }
+
+        lock.lock();
+      }
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::vector<worker*> idle_workers_;
+};
+
+
+inline concurrent_thread_pool& system_concurrent_thread_pool()
+{
+  static concurrent_thread_pool resource;
+  return resource;
+}
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <agency/detail/concurrency/this_fiber.hpp>
+
+#include <ucontext.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+constexpr std::size_t default_fiber_stack_size = 64 * 1024;
+
+
+// fiber_stack_pool caches the stacks of finished fibers so that they may be reused by later fibers
+class fiber_stack_pool
+{
+  public:
+    fiber_stack_pool() = default;
+
+    ~fiber_stack_pool()
+    {
+      for(auto& size_and_stacks : stacks_)
+      {
+        for(void* stack : size_and_stacks.second)
+        {
+          std::free(stack);
+        }
+      }
+    }
+
+    void* allocate(std::size_t stack_size)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::vector<void*>& stacks = stacks_[stack_size];
+        if(!stacks.empty())
+        {
+          void* result = stacks.back();
+          stacks.pop_back();
+          return result;
+        }
+      }
+
+      void* result = std::malloc(stack_size);
+      if(!result) throw std::bad_alloc();
+
+      return result;
+    }
+
+    void deallocate(void* stack, std::size_t stack_size)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stacks_[stack_size].push_back(stack);
+    }
+
+  private:
+    std::mutex mutex_;
+    std::unordered_map<std::size_t, std::vector<void*>> stacks_;
+};
+
+
+inline fiber_stack_pool& system_fiber_stack_pool()
+{
+  static fiber_stack_pool resource;
+  return resource;
+}
+
+
+// fiber is a stackful coroutine
+// a fiber executes its function on its own stack until the function suspends the fiber or returns
+class fiber
+{
+  public:
+    template<class Function>
+    fiber(Function&& f, std::size_t stack_size = default_fiber_stack_size)
+      : f_(std::forward<Function>(f)),
+        stack_size_(stack_size),
+        stack_(system_fiber_stack_pool().allocate(stack_size)),
+        is_finished_(false),
+        caller_context_(nullptr)
+    {
+      getcontext(&context_);
+      context_.uc_stack.ss_sp = stack_;
+      context_.uc_stack.ss_size = stack_size_;
+      context_.uc_link = nullptr;
+
+      // makecontext() passes only int arguments, so pass this pointer in two halves
+      std::uintptr_t self = reinterpret_cast<std::uintptr_t>(this);
+      unsigned int high = static_cast<unsigned int>((self >> 16) >> 16);
+      unsigned int low = static_cast<unsigned int>(self);
+
+      makecontext(&context_, reinterpret_cast<void(*)()>(&fiber::entry), 2, high, low);
+    }
+
+    fiber(const fiber&) = delete;
+
+    ~fiber()
+    {
+      system_fiber_stack_pool().deallocate(stack_, stack_size_);
+    }
+
+    // executes this fiber until it suspends itself or finishes
+    // precondition: !is_finished()
+    void resume()
+    {
+      ucontext_t caller_context;
+      caller_context_ = &caller_context;
+      swapcontext(&caller_context, &context_);
+    }
+
+    // returns control to the context which resumed this fiber
+    // precondition: this fiber is executing
+    void suspend()
+    {
+      swapcontext(&context_, caller_context_);
+    }
+
+    bool is_finished() const
+    {
+      return is_finished_;
+    }
+
+  private:
+    static void entry(unsigned int high, unsigned int low)
+    {
+      std::uintptr_t self_address = (static_cast<std::uintptr_t>(high) << 16 << 16) | static_cast<std::uintptr_t>(low);
+      fiber* self = reinterpret_cast<fiber*>(self_address);
+
+      try
+      {
+        self->f_();
+      }
+      catch(...)
+      {
+        // an exception may not unwind past the beginning of the fiber's stack
+        std::terminate();
+      }
+
+      // release the function's resources before returning control
+      self->f_ = nullptr;
+      self->is_finished_ = true;
+
+      setcontext(self->caller_context_);
+    }
+
+    unique_function<void()> f_;
+    std::size_t stack_size_;
+    void* stack_;
+    bool is_finished_;
+    ucontext_t context_;
+    ucontext_t* caller_context_;
+};
+
+
+// fiber_scheduler executes a collection of fibers on the current thread
+// the fibers are scheduled round-robin and switch only when a fiber yields or finishes
+class fiber_scheduler : public fiber_yielder
+{
+  public:
+    explicit fiber_scheduler(std::size_t stack_size = default_fiber_stack_size)
+      : stack_size_(stack_size),
+        current_fiber_(nullptr)
+    {}
+
+    template<class Function>
+    void spawn(Function&& f)
+    {
+      fibers_.emplace_back(new fiber(std::forward<Function>(f), stack_size_));
+    }
+
+    // executes all spawned fibers until each has finished
+    void run()
+    {
+      fiber_yielder* previous_yielder = this_fiber::current_yielder();
+
+      while(!fibers_.empty())
+      {
+        for(auto& f : fibers_)
+        {
+          current_fiber_ = f.get();
+
+          this_fiber::current_yielder() = this;
+          current_fiber_->resume();
+          this_fiber::current_yielder() = previous_yielder;
+
+          if(current_fiber_->is_finished())
+          {
+            // return the finished fiber's stack to the pool
+            f.reset();
+          }
+        }
+
+        current_fiber_ = nullptr;
+
+        // remove finished fibers
+        fibers_.erase(std::remove(fibers_.begin(), fibers_.end(), nullptr), fibers_.end());
+
+        if(!fibers_.empty())
+        {
+          // every remaining fiber is waiting, possibly on fibers executing in other threads
+          std::this_thread::yield();
+        }
+      }
+    }
+
+    void yield()
+    {
+      current_fiber_->suspend();
+    }
+
+  private:
+    std::size_t stack_size_;
+    std::vector<std::unique_ptr<fiber>> fibers_;
+    fiber* current_fiber_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/detail/concurrency/synchronic>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/spin_wait.hpp>
 
 #include <atomic>
+#include <cstddef>
 #include <mutex>
 #include <condition_variable>
+#include <stdexcept>
 
 
 namespace agency
@@ -14,21 +17,23 @@ namespace detail
 {
 
 
-class synchronic_latch
+// atomic_wait_latch spins briefly and then blocks with atomic_wait()
+class atomic_wait_latch
 {
   public:
-    inline explicit synchronic_latch(ptrdiff_t count)
+    inline explicit atomic_wait_latch(ptrdiff_t count)
       : counter_(count),
-        released_(false)
+        is_ready_(0)
     {
-      if(counter_ == 0) throw std::invalid_argument("latch: count may not be 0.");
+      if(count == 0) throw std::invalid_argument("latch: count may not be 0.");
     }
 
     inline void count_down(ptrdiff_t n)
     {
-      if((counter_ -= n) == 0)
+      if(counter_.fetch_sub(n) == n)
       {
-        notifier_.notify_all(released_, true);
+        is_ready_.store(1);
+        atomic_notify_all(is_ready_);
       }
     }
 
@@ -40,21 +45,28 @@ class synchronic_latch
 
     inline void wait()
     {
-      if(!is_ready())
+      exponential_backoff backoff;
+      for(size_t i = 0; i < max_num_spins; ++i)
       {
-        notifier_.wait(released_, true);
+        if(is_ready()) return;
+
+        backoff.pause();
       }
+
+      atomic_wait(is_ready_, 0);
     }
 
     inline bool is_ready() const
     {
-      return counter_ == 0;
+      return is_ready_.load() != 0;
     }
 
   private:
-    std::atomic<size_t> counter_;
-    std::atomic<bool> released_;
-    std::experimental::synchronic<bool, std::experimental::synchronic_option::optimize_for_short_wait> notifier_;
+    // the number of times a waiting thread pauses before it blocks
+    static constexpr size_t max_num_spins = 16;
+
+    std::atomic<ptrdiff_t> counter_;
+    std::atomic<int> is_ready_;
 };
 
 
@@ -114,8 +126,7 @@ class condition_variable_latch
 };
 
 
-// condition_variable_latch is much faster than synchronic_latch for some reason
-using latch = condition_variable_latch;
+using latch = atomic_wait_latch;
 
 
 } // end detail
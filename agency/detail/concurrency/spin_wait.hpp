@@ -0,0 +1,75 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define __AGENCY_HAS_MM_PAUSE
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// cpu_relax() tells the processor that the calling thread is spinning
+// on x86 this is the pause instruction, which yields execution resources to the core's other hardware thread
+// and avoids the pipeline flush which otherwise occurs when a spin loop exits
+inline void cpu_relax()
+{
+#if defined(__AGENCY_HAS_MM_PAUSE)
+  _mm_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+
+// exponential_backoff spins for twice as long each time pause() is called, up to a limit
+// the limit is small so that a thread which spins with exponential_backoff notices a change within a microsecond or so
+// once the limit is reached, each pause() also yields, so that spinning threads do not starve others of an oversubscribed processor
+class exponential_backoff
+{
+  public:
+    static constexpr unsigned max_num_relaxations = 64;
+
+    exponential_backoff()
+      : num_relaxations_(1)
+    {}
+
+    void pause()
+    {
+      for(unsigned i = 0; i < num_relaxations_; ++i)
+      {
+        cpu_relax();
+      }
+
+      if(num_relaxations_ < max_num_relaxations)
+      {
+        num_relaxations_ *= 2;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    void reset()
+    {
+      num_relaxations_ = 1;
+    }
+
+  private:
+    unsigned num_relaxations_;
+};
+
+
+} // end detail
+} // end agency
+
+#undef __AGENCY_HAS_MM_PAUSE
+
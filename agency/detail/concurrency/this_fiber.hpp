@@ -0,0 +1,54 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// fiber_yielder is the interface through which synchronization primitives suspend
+// the fiber executing in the current thread
+class fiber_yielder
+{
+  public:
+    virtual void yield() = 0;
+
+  protected:
+    ~fiber_yielder() = default;
+};
+
+
+namespace this_fiber
+{
+
+
+// returns a reference to the yielder of the fiber executing in the current thread,
+// or to nullptr if the current thread is not executing a fiber
+inline fiber_yielder*& current_yielder()
+{
+  static thread_local fiber_yielder* result = nullptr;
+  return result;
+}
+
+
+inline bool is_fiber()
+{
+  return current_yielder() != nullptr;
+}
+
+
+// suspends the fiber executing in the current thread so that other fibers may execute
+// precondition: is_fiber()
+inline void yield()
+{
+  current_yielder()->yield();
+}
+
+
+} // end this_fiber
+} // end detail
+} // end agency
+
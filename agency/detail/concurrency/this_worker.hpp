@@ -0,0 +1,62 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// worker_pool is the interface through which a worker thread which waits
+// helps the pool which owns it make progress
+class worker_pool
+{
+  public:
+    // executes a single queued task on the calling worker thread, if one exists
+    // returns whether a task was executed
+    virtual bool try_execute_one_task() = 0;
+
+    // announce that the calling worker thread is about to block, and that it no longer is
+    // the pool may start a spare worker in the meantime
+    virtual void begin_blocking() = 0;
+    virtual void end_blocking() = 0;
+
+  protected:
+    ~worker_pool() = default;
+};
+
+
+namespace this_worker
+{
+
+
+// returns a reference to the pool which owns the current thread,
+// or to nullptr if the current thread is not a pool's worker
+inline worker_pool*& current_pool()
+{
+  static thread_local worker_pool* result = nullptr;
+  return result;
+}
+
+
+inline bool is_worker()
+{
+  return current_pool() != nullptr;
+}
+
+
+// executes a single task queued in the current thread's pool, if one exists
+// returns whether a task was executed
+// precondition: is_worker()
+inline bool try_execute_one_task()
+{
+  return current_pool()->try_execute_one_task();
+}
+
+
+} // end this_worker
+} // end detail
+} // end agency
+
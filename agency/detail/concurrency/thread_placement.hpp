@@ -0,0 +1,445 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+namespace thread_placement_detail
+{
+
+
+// parses a Linux CPU list such as "0-3,8-11"
+inline std::vector<int> parse_cpu_list(const std::string& list)
+{
+  std::vector<int> result;
+
+  std::stringstream stream(list);
+  std::string range;
+  while(std::getline(stream, range, ','))
+  {
+    size_t first_digit = range.find_first_of("0123456789");
+    if(first_digit == std::string::npos) continue;
+
+    int first = std::atoi(range.c_str() + first_digit);
+    int last = first;
+
+    size_t dash = range.find('-', first_digit);
+    if(dash != std::string::npos)
+    {
+      last = std::atoi(range.c_str() + dash + 1);
+    }
+
+    for(int cpu = first; cpu <= last; ++cpu)
+    {
+      result.push_back(cpu);
+    }
+  }
+
+  return result;
+}
+
+
+// returns the CPUs on which the calling thread may run
+inline std::vector<int> allowed_cpus()
+{
+  std::vector<int> result;
+
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  if(sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if(CPU_ISSET(cpu, &set))
+      {
+        result.push_back(cpu);
+      }
+    }
+  }
+#endif
+
+  if(result.empty())
+  {
+    int n = std::max(1u, std::thread::hardware_concurrency());
+    for(int cpu = 0; cpu < n; ++cpu)
+    {
+      result.push_back(cpu);
+    }
+  }
+
+  return result;
+}
+
+
+// restricts the calling thread to the given CPUs
+// returns whether the calling thread's affinity was changed
+inline bool bind_this_thread(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+  if(cpus.empty()) return false;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  for(int cpu : cpus)
+  {
+    if(0 <= cpu && cpu < CPU_SETSIZE)
+    {
+      CPU_SET(cpu, &set);
+    }
+  }
+
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+
+} // end thread_placement_detail
+
+
+// numa_topology lists the CPUs belonging to each NUMA node
+//
+// Nodes are numbered consecutively from zero, in the order of the system's node numbers.
+// Nodes without CPUs on which the process may run are omitted.
+class numa_topology
+{
+  public:
+    explicit numa_topology(std::vector<std::vector<int>> node_cpus)
+      : node_cpus_(std::move(node_cpus))
+    {}
+
+    // the topology of the system, read from /sys/devices/system/node
+    // if the topology cannot be read, the system is described as a single node
+    static const numa_topology& system()
+    {
+      static numa_topology result = read_system_topology();
+      return result;
+    }
+
+    size_t num_nodes() const
+    {
+      return node_cpus_.size();
+    }
+
+    const std::vector<int>& cpus(size_t node) const
+    {
+      return node_cpus_.at(node);
+    }
+
+    size_t num_cpus() const
+    {
+      size_t result = 0;
+      for(const auto& cpus : node_cpus_)
+      {
+        result += cpus.size();
+      }
+
+      return result;
+    }
+
+    // returns the node containing cpu, or num_nodes() if no node contains it
+    size_t node_of(int cpu) const
+    {
+      for(size_t node = 0; node < num_nodes(); ++node)
+      {
+        if(std::find(node_cpus_[node].begin(), node_cpus_[node].end(), cpu) != node_cpus_[node].end())
+        {
+          return node;
+        }
+      }
+
+      return num_nodes();
+    }
+
+  private:
+    static numa_topology read_system_topology()
+    {
+      std::vector<int> allowed = thread_placement_detail::allowed_cpus();
+      std::vector<std::vector<int>> node_cpus;
+
+#if defined(__linux__)
+      const std::string path = "/sys/devices/system/node";
+
+      std::vector<int> system_nodes;
+
+      if(DIR* dir = opendir(path.c_str()))
+      {
+        while(dirent* entry = readdir(dir))
+        {
+          std::string name = entry->d_name;
+
+          if(name.size() > 4 && name.compare(0, 4, "node") == 0 && name.find_first_not_of("0123456789", 4) == std::string::npos)
+          {
+            system_nodes.push_back(std::atoi(name.c_str() + 4));
+          }
+        }
+
+        closedir(dir);
+      }
+
+      std::sort(system_nodes.begin(), system_nodes.end());
+
+      for(int node : system_nodes)
+      {
+        std::ifstream file(path + "/node" + std::to_string(node) + "/cpulist");
+
+        std::string list;
+        std::getline(file, list);
+
+        // keep only the CPUs on which we may run
+        std::vector<int> cpus;
+        for(int cpu : thread_placement_detail::parse_cpu_list(list))
+        {
+          if(std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+          {
+            cpus.push_back(cpu);
+          }
+        }
+
+        if(!cpus.empty())
+        {
+          node_cpus.push_back(std::move(cpus));
+        }
+      }
+#endif
+
+      if(node_cpus.empty())
+      {
+        node_cpus.push_back(allowed);
+      }
+
+      return numa_topology(std::move(node_cpus));
+    }
+
+    std::vector<std::vector<int>> node_cpus_;
+};
+
+
+// placement_policy describes the CPUs on which each worker of a thread pool runs
+//
+// Workers are assigned to CPUs by their index, so a caller which knows a pool's placement_policy
+// may partition its data to match:
+//
+// * unpinned:  workers run wherever the operating system schedules them
+// * compact:   worker i runs on the i-th CPU, filling each NUMA node before the next
+// * scatter:   worker i runs on a CPU of node i % num_nodes, spreading workers across nodes
+// * cpus:      worker i runs on the i-th CPU of an explicit list
+// * numa_node: every worker may run on any CPU of a single node
+//
+// When there are more workers than CPUs, the assignment wraps around.
+// To create one pool per NUMA node, create a pool with placement_policy::numa_node(node) for each node.
+class placement_policy
+{
+  public:
+    enum class kind_type
+    {
+      unpinned,
+      compact,
+      scatter,
+      cpus,
+      numa_node
+    };
+
+    static placement_policy unpinned()
+    {
+      return placement_policy(kind_type::unpinned);
+    }
+
+    static placement_policy compact()
+    {
+      return placement_policy(kind_type::compact);
+    }
+
+    static placement_policy scatter()
+    {
+      return placement_policy(kind_type::scatter);
+    }
+
+    static placement_policy cpus(std::vector<int> cpu_list)
+    {
+      if(cpu_list.empty())
+      {
+        throw std::invalid_argument("placement_policy::cpus(): cpu_list is empty");
+      }
+
+      placement_policy result(kind_type::cpus);
+      result.cpu_list_ = std::move(cpu_list);
+      return result;
+    }
+
+    static placement_policy numa_node(size_t node)
+    {
+      placement_policy result(kind_type::numa_node);
+      result.node_ = node;
+      return result;
+    }
+
+    kind_type kind() const
+    {
+      return kind_;
+    }
+
+    // the CPUs given to cpus()
+    const std::vector<int>& cpu_list() const
+    {
+      return cpu_list_;
+    }
+
+    // the node given to numa_node()
+    size_t node() const
+    {
+      return node_;
+    }
+
+    // the number of workers which occupies each CPU of this placement once
+    size_t default_num_threads(const numa_topology& topology = numa_topology::system()) const
+    {
+      switch(kind_)
+      {
+        case kind_type::cpus:
+        {
+          return cpu_list_.size();
+        }
+
+        case kind_type::numa_node:
+        {
+          return topology.cpus(checked_node(topology)).size();
+        }
+
+        case kind_type::compact:
+        case kind_type::scatter:
+        {
+          return topology.num_cpus();
+        }
+
+        default:
+        {
+          return std::max(1u, std::thread::hardware_concurrency());
+        }
+      }
+    }
+
+    // returns the CPUs on which the given worker runs
+    // an empty result means the worker is unpinned
+    std::vector<int> worker_cpus(size_t worker, const numa_topology& topology = numa_topology::system()) const
+    {
+      switch(kind_)
+      {
+        case kind_type::compact:
+        {
+          size_t i = worker % topology.num_cpus();
+
+          for(size_t node = 0; ; ++node)
+          {
+            const std::vector<int>& cpus = topology.cpus(node);
+
+            if(i < cpus.size())
+            {
+              return std::vector<int>(1, cpus[i]);
+            }
+
+            i -= cpus.size();
+          }
+        }
+
+        case kind_type::scatter:
+        {
+          const std::vector<int>& cpus = topology.cpus(worker % topology.num_nodes());
+          size_t i = (worker / topology.num_nodes()) % cpus.size();
+
+          return std::vector<int>(1, cpus[i]);
+        }
+
+        case kind_type::cpus:
+        {
+          return std::vector<int>(1, cpu_list_[worker % cpu_list_.size()]);
+        }
+
+        case kind_type::numa_node:
+        {
+          return topology.cpus(checked_node(topology));
+        }
+
+        default:
+        {
+          return std::vector<int>();
+        }
+      }
+    }
+
+    // returns the NUMA node on which the given worker runs, or topology.num_nodes() if the worker is unpinned
+    size_t worker_node(size_t worker, const numa_topology& topology = numa_topology::system()) const
+    {
+      std::vector<int> cpus = worker_cpus(worker, topology);
+
+      return cpus.empty() ? topology.num_nodes() : topology.node_of(cpus.front());
+    }
+
+    friend bool operator==(const placement_policy& a, const placement_policy& b)
+    {
+      return a.kind_ == b.kind_ && a.cpu_list_ == b.cpu_list_ && a.node_ == b.node_;
+    }
+
+    friend bool operator!=(const placement_policy& a, const placement_policy& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    explicit placement_policy(kind_type kind)
+      : kind_(kind),
+        node_(0)
+    {}
+
+    size_t checked_node(const numa_topology& topology) const
+    {
+      if(node_ >= topology.num_nodes())
+      {
+        throw std::out_of_range("placement_policy::numa_node(): node does not exist");
+      }
+
+      return node_;
+    }
+
+    kind_type kind_;
+    std::vector<int> cpu_list_;
+    size_t node_;
+};
+
+
+// thread_placement is the property through which an executor reports
+// the placement_policy of the threads which execute its agents
+struct thread_placement_t {};
+
+namespace
+{
+
+constexpr thread_placement_t thread_placement{};
+
+} // end anonymous namespace
+
+
+} // end detail
+} // end agency
+
@@ -6,17 +6,35 @@
 #include <agency/execution/executor/scoped_executor.hpp>
 #include <agency/execution/executor/flattened_executor.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
 #include <agency/detail/concurrency/latch.hpp>
 #include <agency/detail/concurrency/concurrent_queue.hpp>
+#include <agency/detail/concurrency/work_stealing_deque.hpp>
+#include <agency/detail/concurrency/this_worker.hpp>
+#include <agency/detail/concurrency/thread_placement.hpp>
+#include <agency/detail/concurrency/spin_wait.hpp>
+#include <agency/detail/concurrency/aligned_unique_array.hpp>
 #include <agency/detail/unique_function.hpp>
 #include <agency/future.hpp>
+#include <agency/future/future.hpp>
+#include <agency/future/promise.hpp>
+#include <agency/future/detail/invoke_when_ready.hpp>
 #include <agency/detail/type_traits.hpp>
 
 #include <thread>
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <functional>
 #include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <exception>
 
 
 namespace agency
@@ -25,208 +43,1569 @@ namespace detail
 {
 
 
-class thread_pool
+// thread_pool_mode selects how a thread_pool distributes tasks among its worker threads
+enum class thread_pool_mode
+{
+  // every worker pops tasks from a single shared queue
+  shared_queue,
+
+  // each worker owns a deque of tasks and steals from other workers' deques when its own is empty
+  // tasks submitted from outside the pool arrive through a separate injection queue
+  work_stealing
+};
+
+
+// task_priority selects the lane through which a task is submitted to a thread_pool
+// waiting high priority tasks execute before any waiting normal priority task
+enum class task_priority
+{
+  normal,
+  high
+};
+
+
+namespace thread_pool_detail
+{
+
+
+// reads a non-negative integer from the named environment variable
+// returns false if the variable is unset or is not a number
+inline bool read_environment(const char* name, size_t& value)
+{
+  const char* str = std::getenv(name);
+  if(!str || !*str) return false;
+
+  char* end = nullptr;
+  unsigned long long result = std::strtoull(str, &end, 10);
+  if(*end != '\0') return false;
+
+  value = static_cast<size_t>(result);
+  return true;
+}
+
+
+} // end thread_pool_detail
+
+
+// thread_pool_elasticity configures a thread_pool whose workers start as work arrives and exit when idle
+//
+// The pool starts min_threads workers when it is created. When a task is submitted and no worker is
+// idle, the pool starts another worker, up to max_threads. A worker which has found no work for
+// idle_timeout exits, unless only min_threads workers remain.
+struct thread_pool_elasticity
+{
+  size_t min_threads;
+  size_t max_threads;
+  std::chrono::milliseconds idle_timeout;
+
+  // the default elasticity allows one worker per hardware thread and starts none of them up front
+  explicit thread_pool_elasticity(size_t min_threads = 0,
+                                  size_t max_threads = std::max(1u, std::thread::hardware_concurrency()),
+                                  std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(1000))
+    : min_threads(min_threads),
+      max_threads(std::max<size_t>(1, max_threads)),
+      idle_timeout(idle_timeout)
+  {
+    this->min_threads = std::min(this->min_threads, this->max_threads);
+  }
+
+  // returns the default elasticity, with each field overridden by an environment variable, if set:
+  //
+  // * AGENCY_NUM_THREADS:     max_threads
+  // * AGENCY_MIN_THREADS:     min_threads
+  // * AGENCY_THREAD_IDLE_MS:  idle_timeout, in milliseconds
+  static thread_pool_elasticity from_environment()
+  {
+    thread_pool_elasticity result;
+
+    size_t value = 0;
+
+    if(thread_pool_detail::read_environment("AGENCY_NUM_THREADS", value) && value > 0)
+    {
+      result.max_threads = value;
+    }
+
+    if(thread_pool_detail::read_environment("AGENCY_MIN_THREADS", value))
+    {
+      result.min_threads = value;
+    }
+
+    if(thread_pool_detail::read_environment("AGENCY_THREAD_IDLE_MS", value))
+    {
+      result.idle_timeout = std::chrono::milliseconds(value);
+    }
+
+    return thread_pool_elasticity(result.min_threads, result.max_threads, result.idle_timeout);
+  }
+
+};
+
+
+// thread_pool_spinning configures idle workers which spin for a while before they sleep
+//
+// Ordinarily, a worker which finds no work sleeps at once, and a task submitted to an idle pool waits
+// for the operating system to wake a worker. When spinning is enabled, up to max_spinning_workers idle
+// workers first spin for spin_duration, pausing with exponential backoff. A task submitted from outside
+// the pool while a worker spins is handed to that worker directly, so launches which closely follow
+// one another do not pay for a wakeup. The price is the CPU time the spinning workers consume.
+struct thread_pool_spinning
+{
+  size_t max_spinning_workers;
+  std::chrono::microseconds spin_duration;
+
+  // the default spinning is disabled
+  explicit thread_pool_spinning(size_t max_spinning_workers = 0,
+                                std::chrono::microseconds spin_duration = std::chrono::microseconds(100))
+    : max_spinning_workers(max_spinning_workers),
+      spin_duration(spin_duration)
+  {}
+
+  bool is_enabled() const
+  {
+    return max_spinning_workers > 0 && spin_duration.count() > 0;
+  }
+
+  // returns the default spinning, with each field overridden by an environment variable, if set:
+  //
+  // * AGENCY_SPINNING_THREADS:  max_spinning_workers
+  // * AGENCY_SPIN_US:           spin_duration, in microseconds
+  static thread_pool_spinning from_environment()
+  {
+    thread_pool_spinning result;
+
+    size_t value = 0;
+
+    if(thread_pool_detail::read_environment("AGENCY_SPINNING_THREADS", value))
+    {
+      result.max_spinning_workers = value;
+    }
+
+    if(thread_pool_detail::read_environment("AGENCY_SPIN_US", value))
+    {
+      result.spin_duration = std::chrono::microseconds(value);
+    }
+
+    return result;
+  }
+};
+
+
+// basic_thread_pool's TaskQueue parameter selects the queue used in thread_pool_mode::shared_queue
+// it may be concurrent_queue, bounded_concurrent_queue, or any queue with the same interface
+//
+// Submitted tasks small enough to be stored inline in a unique_function are enqueued without allocation.
+// basic_thread_pool's TaskAllocator parameter allocates the storage of larger tasks. Because tasks may be
+// submitted and destroyed by different threads at once, TaskAllocator must be safe to use concurrently.
+//
+// A placement_policy passed to the constructor pins each worker thread to CPUs. Pinning is best effort:
+// a worker whose affinity cannot be set runs unpinned.
+//
+// A pool created with a thread_pool_elasticity starts and retires its workers on demand.
+// Other pools start all of their workers when created and keep them until destroyed.
+//
+// set_spinning() lets idle workers of a thread_pool_mode::work_stealing pool spin before they sleep.
+//
+// A worker of a thread_pool_mode::work_stealing pool which is about to block outside of the pool, for example
+// on I/O, may announce it with begin_blocking(). Until the matching end_blocking(), the pool may start a spare
+// worker to take its place, so that the pool's other work continues to occupy size() workers. A pool has
+// at most size() spare workers. Spare workers exit once they are no longer needed.
+template<template<class> class TaskQueue = concurrent_queue, class TaskAllocator = std::allocator<char>>
+class basic_thread_pool : public worker_pool
 {
   private:
     struct joining_thread : std::thread
     {
-      using std::thread::thread;
+      using std::thread::thread;
+
+      joining_thread() = default;
+
+      joining_thread(joining_thread&&) = default;
+
+      joining_thread& operator=(joining_thread&&) = default;
+
+      ~joining_thread()
+      {
+        if(joinable()) join();
+      }
+    };
+
+    using task_deque = work_stealing_deque<unique_function<void()>>;
+
+    // a mailbox through which a submitter hands a task directly to a spinning worker
+    // each mailbox occupies its own cache line so that workers spinning on their mailboxes do not interfere
+    struct alignas(64) mailbox
+    {
+      enum state_type : int
+      {
+        // the worker is not spinning
+        closed,
+
+        // the worker is spinning and will accept a task
+        open,
+
+        // a submitter has claimed the mailbox and is moving its task inside
+        filling,
+
+        // the task has arrived
+        full
+      };
+
+      std::atomic<int> state;
+      unique_function<void()> task;
+
+      mailbox() : state(closed) {}
+    };
+
+    // the maximum number of tasks a worker moves from the injection queue to its own deque at once
+    static constexpr size_t injection_batch_size = 16;
+
+  public:
+    // the maximum number of indices claimed at once by the tasks submitted by bulk_submit()
+    static constexpr size_t max_bulk_chunk_size = 2048;
+
+    explicit basic_thread_pool(size_t num_threads = std::max(1u, std::thread::hardware_concurrency()),
+                               thread_pool_mode mode = thread_pool_mode::work_stealing,
+                               const TaskAllocator& task_allocator = TaskAllocator())
+      : basic_thread_pool(num_threads, mode, placement_policy::unpinned(), task_allocator)
+    {}
+
+    // creates a worker for each CPU of the placement
+    explicit basic_thread_pool(const placement_policy& placement,
+                               thread_pool_mode mode = thread_pool_mode::work_stealing,
+                               const TaskAllocator& task_allocator = TaskAllocator())
+      : basic_thread_pool(placement.default_num_threads(), mode, placement, task_allocator)
+    {}
+
+    basic_thread_pool(size_t num_threads,
+                      thread_pool_mode mode,
+                      const placement_policy& placement,
+                      const TaskAllocator& task_allocator = TaskAllocator())
+      : basic_thread_pool(thread_pool_elasticity(num_threads, num_threads), mode, placement, task_allocator)
+    {}
+
+    // creates an elastic pool in thread_pool_mode::work_stealing
+    explicit basic_thread_pool(const thread_pool_elasticity& elasticity,
+                               const placement_policy& placement = placement_policy::unpinned(),
+                               const TaskAllocator& task_allocator = TaskAllocator())
+      : basic_thread_pool(elasticity, thread_pool_mode::work_stealing, placement, task_allocator)
+    {}
+
+  private:
+    basic_thread_pool(const thread_pool_elasticity& elasticity,
+                      thread_pool_mode mode,
+                      const placement_policy& placement,
+                      const TaskAllocator& task_allocator)
+      : placement_(placement),
+        task_allocator_(task_allocator),
+        mode_(mode),
+        // workers of a shared_queue pool cannot tell whether the queue is idle, so they never retire
+        min_threads_(mode == thread_pool_mode::work_stealing ? elasticity.min_threads : elasticity.max_threads),
+        max_threads_(elasticity.max_threads),
+        idle_timeout_(elasticity.idle_timeout),
+        // work_stealing pools reserve a slot for a spare worker for each of their workers
+        num_slots_(mode == thread_pool_mode::work_stealing ? 2 * max_threads_ : max_threads_),
+        is_stopping_(false),
+        num_sleeping_(0),
+        num_running_(0),
+        num_blocked_(0),
+        threads_(num_slots_),
+        is_running_(num_slots_, false),
+        max_spinning_workers_(0),
+        spin_duration_ns_(0),
+        num_spinning_(0)
+    {
+      if(mode_ == thread_pool_mode::work_stealing)
+      {
+        // create each worker's deque before any thread begins stealing from it
+        for(size_t i = 0; i < num_slots_; ++i)
+        {
+          worker_tasks_.emplace_back(new task_deque);
+        }
+
+        mailboxes_ = make_aligned_unique_array<mailbox>(num_slots_);
+      }
+
+      // assign CPUs to each worker before any worker begins
+      for(size_t i = 0; i < num_slots_; ++i)
+      {
+        worker_cpus_.push_back(placement_.worker_cpus(i));
+      }
+
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+
+      for(size_t i = 0; i < min_threads_; ++i)
+      {
+        start_worker(i);
+      }
+    }
+
+  public:
+    
+    ~basic_thread_pool()
+    {
+      if(mode_ == thread_pool_mode::work_stealing)
+      {
+        {
+          std::unique_lock<std::mutex> lock(sleep_mutex_);
+          is_stopping_ = true;
+        }
+
+        wake_up_.notify_all();
+      }
+      else
+      {
+        tasks_.close();
+      }
+
+      // no worker starts once is_stopping_ is set, so threads_ no longer changes
+      threads_.clear();
+    }
+
+    template<class Function,
+             class = result_of_t<Function()>>
+    inline void submit(Function&& f, task_priority priority = task_priority::normal)
+    {
+      if(priority == task_priority::high && (mode_ == thread_pool_mode::work_stealing || this_worker::current_pool() != this))
+      {
+        high_priority_tasks_.emplace_back(make_task(std::forward<Function>(f)));
+
+        if(mode_ == thread_pool_mode::work_stealing)
+        {
+          wake_one();
+        }
+        else
+        {
+          // workers of a shared_queue pool sleep inside the shared queue, so enqueue a task there
+          // which executes the high priority task, in case no worker looks in the high priority lane sooner
+          tasks_.emplace(make_task([this]
+          {
+            execute_high_priority_tasks();
+          }));
+        }
+      }
+      else if(this_worker::current_pool() != this)
+      {
+        if(mode_ == thread_pool_mode::work_stealing)
+        {
+          unique_function<void()> task = make_task(std::forward<Function>(f));
+
+          // prefer a spinning worker, which begins the task without waiting to be woken
+          if(!try_deliver(task))
+          {
+            injected_tasks_.emplace_back(std::move(task));
+            wake_one();
+          }
+        }
+        else
+        {
+          tasks_.emplace(make_task(std::forward<Function>(f)));
+        }
+      }
+      else if(mode_ == thread_pool_mode::work_stealing)
+      {
+        // the submitting thread is one of our workers, so push the task onto the worker's own deque
+        // the worker executes the task itself unless another worker steals it first
+        // this does not deadlock when the worker waits on an agency::future for the task's result,
+        // because such waits execute queued tasks rather than blocking the worker
+        worker_tasks_[this_worker_state().index]->emplace_back(make_task(std::forward<Function>(f)));
+        wake_one();
+      }
+      else
+      {
+        // the submitting thread is part of this pool so execute immediately to avoid deadlock
+        std::forward<Function>(f)();
+      }
+    }
+
+  private:
+    template<class Function>
+    inline unique_function<void()> make_task(Function&& f)
+    {
+      return unique_function<void()>(std::allocator_arg, task_allocator_, std::forward<Function>(f));
+    }
+
+    // the interface through which a worker which blocks in the middle of a bulk launch
+    // lets a spare worker claim the launch's remaining chunks
+    struct bulk_task_base
+    {
+      virtual void submit_helper(basic_thread_pool& pool) = 0;
+
+      protected:
+        ~bulk_task_base() = default;
+    };
+
+    template<class Function>
+    struct bulk_task_state : bulk_task_base, std::enable_shared_from_this<bulk_task_state<Function>>
+    {
+      Function f;
+      size_t n;
+      size_t chunk_size;
+      std::atomic<size_t> next_idx;
+
+      // the number of indices whose invocations have not yet completed
+      std::atomic<size_t> num_remaining;
+      std::mutex mutex;
+      std::condition_variable completed;
+
+      // the first exception thrown by an invocation of f on a task of bulk_invoke()
+      std::exception_ptr exception;
+
+      bulk_task_state(const Function& f, size_t n, size_t chunk_size)
+        : f(f), n(n), chunk_size(chunk_size), next_idx(0), num_remaining(n)
+      {}
+
+      // claims chunks of indices until none remain
+      // between chunks, a calling worker executes any waiting high priority tasks
+      //
+      // when an invocation of f throws, no further chunks are claimed by any participant,
+      // the chunk in progress and every unclaimed chunk are counted as complete,
+      // and the exception is returned rather than rethrown so that each caller may decide how to report it
+      std::exception_ptr execute_chunks(basic_thread_pool& pool)
+      {
+        bool is_worker = this_worker::current_pool() == &pool;
+
+        // begin_blocking() submits helpers for the current bulk task to the pool of the blocking worker,
+        // so only a worker of this task's pool records it
+        current_bulk_task_guard guard(is_worker ? this : this_worker_state().current_bulk_task);
+
+        size_t first = 0;
+        while((first = next_idx.fetch_add(chunk_size)) < n)
+        {
+          size_t last = std::min(first + chunk_size, n);
+
+          try
+          {
+            for(size_t idx = first; idx < last; ++idx)
+            {
+              f(idx);
+            }
+          }
+          catch(...)
+          {
+            cancel_unclaimed_chunks(last - first);
+            return std::current_exception();
+          }
+
+          complete(last - first);
+
+          if(is_worker)
+          {
+            pool.execute_high_priority_tasks();
+          }
+        }
+
+        return nullptr;
+      }
+
+      // restores the calling thread's current_bulk_task when execute_chunks() returns or throws
+      struct current_bulk_task_guard
+      {
+        bulk_task_base*& current_bulk_task;
+        bulk_task_base* enclosing_bulk_task;
+
+        current_bulk_task_guard(bulk_task_base* bulk_task)
+          : current_bulk_task(this_worker_state().current_bulk_task),
+            enclosing_bulk_task(current_bulk_task)
+        {
+          current_bulk_task = bulk_task;
+        }
+
+        ~current_bulk_task_guard()
+        {
+          current_bulk_task = enclosing_bulk_task;
+        }
+      };
+
+      // records e, unless it is null or an exception has already been recorded
+      void set_exception(std::exception_ptr e)
+      {
+        if(e)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if(!exception)
+          {
+            exception = e;
+          }
+        }
+      }
+
+      // rethrows the recorded exception, if any
+      void rethrow_exception()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(exception)
+        {
+          std::rethrow_exception(exception);
+        }
+      }
+
+      // counts num_invocations invocations as complete
+      void complete(size_t num_invocations)
+      {
+        if(num_remaining.fetch_sub(num_invocations) == num_invocations)
+        {
+          // notify while holding the lock so that a waiter cannot miss the notification
+          std::lock_guard<std::mutex> lock(mutex);
+          completed.notify_all();
+        }
+      }
+
+      // prevents any further chunk from being claimed, and counts the unclaimed indices
+      // and the num_abandoned indices of the calling participant's chunk as complete
+      void cancel_unclaimed_chunks(size_t num_abandoned)
+      {
+        size_t num_claimed = std::min(next_idx.exchange(n), n);
+
+        complete((n - num_claimed) + num_abandoned);
+      }
+
+      bool is_complete() const
+      {
+        return num_remaining.load() == 0;
+      }
+
+      // waits until every invocation has completed
+      // a calling worker executes the pool's other tasks meanwhile
+      void wait(basic_thread_pool& pool)
+      {
+        if(this_worker::current_pool() == &pool)
+        {
+          while(!is_complete())
+          {
+            if(!pool.try_execute_one_task())
+            {
+              std::this_thread::yield();
+            }
+          }
+        }
+        else
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          completed.wait(lock, [this]{ return is_complete(); });
+        }
+      }
+
+      // submits another task which claims chunks, if any remain
+      void submit_helper(basic_thread_pool& pool)
+      {
+        if(next_idx.load() >= n) return;
+
+        auto self = this->shared_from_this();
+        basic_thread_pool* p = &pool;
+
+        pool.submit([=]
+        {
+          self->execute_chunks(*p);
+        });
+      }
+    };
+
+  public:
+    // bulk_submit() invokes f(idx) for each idx in [0, n)
+    //
+    // Rather than submitting a separate task for each idx, bulk_submit() submits at most size() tasks
+    // which share a single copy of f. These tasks claim chunks of indices through an atomic counter, so
+    // the cost of submission is independent of n and uneven per-index costs are balanced at runtime.
+    //
+    // No more than max_concurrency tasks are submitted, so the invocations occupy at most max_concurrency
+    // workers at once, leaving the others free for other work.
+    //
+    // Chunks contain no more than max_bulk_chunk_size indices. Between chunks, workers execute waiting
+    // high priority tasks, so a long launch delays a high priority task by at most about one chunk.
+    //
+    // f is destroyed after the final invocation has completed
+    template<class Function,
+             class = result_of_t<Function(size_t)>>
+    inline void bulk_submit(Function f, size_t n,
+                            size_t max_concurrency = std::numeric_limits<size_t>::max(),
+                            task_priority priority = task_priority::normal)
+    {
+      if(n == 0) return;
+
+      size_t num_tasks = std::min(n, std::min(size(), std::max<size_t>(1, max_concurrency)));
+
+      // aim for several chunks per task so that tasks which finish early may help the others
+      const size_t chunks_per_task = 8;
+      size_t chunk_size = std::max<size_t>(1, n / (num_tasks * chunks_per_task));
+      chunk_size = std::min(chunk_size, max_bulk_chunk_size);
+
+      auto state = std::make_shared<bulk_task_state<Function>>(f, n, chunk_size);
+
+      auto task = [=]() mutable
+      {
+        std::exception_ptr e = state->execute_chunks(*this);
+        if(e)
+        {
+          // bulk_submit() has no caller to report the exception to, so it escapes the task as before
+          std::rethrow_exception(e);
+        }
+
+        // we explicitly release state because even though this
+        // lambda's invocation is complete, the lambda's lifetime
+        // (and therefore state's lifetime) is not necessarily complete
+        state.reset();
+      };
+
+      if(mode_ == thread_pool_mode::shared_queue && this_worker::current_pool() != this && priority == task_priority::normal)
+      {
+        // enqueue every task at once so that the queue wakes the workers once
+        std::vector<unique_function<void()>> tasks;
+        tasks.reserve(num_tasks);
+
+        for(size_t i = 0; i < num_tasks; ++i)
+        {
+          tasks.emplace_back(make_task(task));
+        }
+
+        tasks_.emplace_n(tasks.begin(), tasks.end());
+      }
+      else
+      {
+        for(size_t i = 0; i < num_tasks; ++i)
+        {
+          submit(task, priority);
+        }
+      }
+    }
+
+    // bulk_invoke() invokes f(idx) for each idx in [0, n) and returns once every invocation has completed
+    //
+    // The calling thread participates in the invocations: it claims chunks of indices alongside the tasks
+    // bulk_invoke() submits to the pool, so the caller's core does not idle while it waits. The caller
+    // counts against max_concurrency only when it is one of this pool's workers.
+    //
+    // f may be a reference to a function which is not copyable.
+    //
+    // When an invocation of f throws, whether on the calling thread or on the pool, the indices not yet claimed
+    // are abandoned. bulk_invoke() waits for the invocations already in progress and then rethrows the exception
+    // to its caller. If several invocations throw, the caller's own exception is preferred, and then the first
+    // exception thrown on the pool.
+    template<class Function,
+             class = result_of_t<Function&(size_t)>>
+    inline void bulk_invoke(Function&& f, size_t n,
+                            size_t max_concurrency = std::numeric_limits<size_t>::max(),
+                            task_priority priority = task_priority::normal)
+    {
+      if(n == 0) return;
+
+      bool caller_is_worker = this_worker::current_pool() == this;
+
+      size_t num_workers = std::min(size(), std::max<size_t>(1, max_concurrency));
+      size_t num_tasks = std::min(n - 1, caller_is_worker ? num_workers - 1 : num_workers);
+      size_t num_participants = num_tasks + 1;
+
+      const size_t chunks_per_participant = 8;
+      size_t chunk_size = std::max<size_t>(1, n / (num_participants * chunks_per_participant));
+      chunk_size = std::min(chunk_size, max_bulk_chunk_size);
+
+      using function_ref = std::reference_wrapper<typename std::remove_reference<Function>::type>;
+
+      // the state outlives this call when a submitted task begins after every index has been claimed
+      // such a task finds no chunk to claim, and so never refers to f
+      auto state = std::make_shared<bulk_task_state<function_ref>>(function_ref(f), n, chunk_size);
+
+      for(size_t i = 0; i < num_tasks; ++i)
+      {
+        submit([=]() mutable
+        {
+          state->set_exception(state->execute_chunks(*this));
+
+          // see bulk_submit()
+          state.reset();
+        },
+        priority);
+      }
+
+      std::exception_ptr caller_exception = state->execute_chunks(*this);
+
+      // even after an exception, wait for the chunks other participants have claimed, because they refer to f
+      state->wait(*this);
+
+      if(caller_exception)
+      {
+        std::rethrow_exception(caller_exception);
+      }
+
+      state->rethrow_exception();
+    }
+
+    // the maximum number of workers
+    inline size_t size() const
+    {
+      return max_threads_;
+    }
+
+    // the number of workers currently started
+    inline size_t num_running_threads() const
+    {
+      return num_running_.load();
+    }
+
+    inline thread_pool_mode mode() const
+    {
+      return mode_;
+    }
+
+    inline const placement_policy& placement() const
+    {
+      return placement_;
+    }
+
+    // configures the workers which spin when idle
+    // workers of a thread_pool_mode::shared_queue pool never spin this way
+    inline void set_spinning(const thread_pool_spinning& spinning)
+    {
+      spin_duration_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(spinning.spin_duration).count());
+      max_spinning_workers_.store(mode_ == thread_pool_mode::work_stealing ? spinning.max_spinning_workers : 0);
+    }
+
+    inline thread_pool_spinning spinning() const
+    {
+      return thread_pool_spinning(max_spinning_workers_.load(),
+                                  std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(spin_duration_ns_.load())));
+    }
+
+    // returns the CPUs on which the given worker runs
+    // an empty result means the worker is unpinned
+    inline const std::vector<int>& worker_cpus(size_t worker) const
+    {
+      return worker_cpus_[worker];
+    }
+
+    // the number of workers currently inside a blocking region
+    inline size_t num_blocked_threads() const
+    {
+      return num_blocked_.load();
+    }
+
+    // announces that the calling worker is about to block
+    // until the matching call to end_blocking(), the pool may start a spare worker to take its place
+    // thread_pool_mode::shared_queue pools ignore this announcement
+    // precondition: the calling thread is one of this pool's workers
+    inline void begin_blocking()
+    {
+      if(mode_ != thread_pool_mode::work_stealing) return;
+
+      ++num_blocked_;
+
+      // when the worker blocks inside a bulk launch, let a spare worker claim the launch's remaining chunks
+      if(bulk_task_base* bulk_task = this_worker_state().current_bulk_task)
+      {
+        bulk_task->submit_helper(*this);
+      }
+
+      // tasks which are already queued, such as those in the blocked worker's own deque, need a worker now
+      // later submissions start spares as needed
+      if(has_queued_tasks())
+      {
+        wake_one();
+      }
+    }
+
+    // announces that the calling worker is no longer blocked
+    // a spare worker started in its place exits once it finds no work
+    inline void end_blocking()
+    {
+      if(mode_ != thread_pool_mode::work_stealing) return;
+
+      --num_blocked_;
+    }
+
+    // executes waiting high priority tasks until none remain
+    inline void execute_high_priority_tasks()
+    {
+      if(high_priority_tasks_.empty()) return;
+
+      unique_function<void()> task;
+      while(high_priority_tasks_.try_steal_front(task))
+      {
+        task();
+        task = nullptr;
+      }
+    }
+
+    // executes a single queued task on the calling worker thread, if one exists
+    // returns whether a task was executed
+    // thread_pool_mode::shared_queue pools never execute tasks this way
+    // precondition: the calling thread is one of this pool's workers
+    inline bool try_execute_one_task()
+    {
+      if(mode_ != thread_pool_mode::work_stealing) return false;
+
+      worker_state& self = this_worker_state();
+
+      unique_function<void()> task;
+      if(find_task(self.index, self.random_state, task))
+      {
+        task();
+        return true;
+      }
+
+      return false;
+    }
+
+    template<class Function, class... Args>
+    std::future<result_of_t<Function(Args...)>>
+      async(Function&& f, Args&&... args)
+    {
+      // bind f & args together
+      auto g = std::bind(std::forward<Function>(f), std::forward<Args>(args)...);
+
+      using result_type = result_of_t<Function(Args...)>;
+
+      // create a packaged task
+      std::packaged_task<result_type()> task(std::move(g));
+
+      // get the packaged task's future so we can return it at the end
+      auto result_future = task.get_future();
+
+      if(this_worker::current_pool() == this)
+      {
+        // a worker which waits on a std::future does not help the pool, so a task queued
+        // behind the worker could deadlock it. execute the worker's own submission immediately
+        task();
+      }
+      else
+      {
+        // move the packaged task into the thread pool
+        submit(std::move(task));
+      }
+
+      return std::move(result_future);
+    }
+
+
+  private:
+    // the worker loop used in thread_pool_mode::shared_queue
+    inline void work()
+    {
+      unique_function<void()> task;
+
+      while(tasks_.wait_and_pop(task))
+      {
+        execute_high_priority_tasks();
+
+        task();
+      }
+    }
+
+    // the worker loop used in thread_pool_mode::work_stealing
+    inline void steal_work(size_t worker_idx)
+    {
+      worker_state& self = this_worker_state();
+      self.index = worker_idx;
+
+      // seed each worker's victim selection differently
+      self.random_state = static_cast<std::uint32_t>(worker_idx) * 2654435761u + 1;
+
+      unique_function<void()> task;
+
+      while(true)
+      {
+        if(find_task(self.index, self.random_state, task))
+        {
+          task();
+
+          // destroy the task's resources before looking for more work
+          task = nullptr;
+        }
+        else if(spin_for_work(self.index, task))
+        {
+          // we either received a task through our mailbox or noticed a queued task
+          if(task)
+          {
+            task();
+            task = nullptr;
+          }
+        }
+        else if(!wait_for_work(self.index))
+        {
+          break;
+        }
+      }
+    }
+
+    inline bool find_task(size_t worker_idx, std::uint32_t& random_state, unique_function<void()>& task)
+    {
+      // high priority tasks come before all others
+      if(high_priority_tasks_.try_steal_front(task))
+      {
+        return true;
+      }
 
-      joining_thread(joining_thread&&) = default;
+      // next, look in our own deque
+      if(worker_tasks_[worker_idx]->try_pop_back(task))
+      {
+        return true;
+      }
 
-      ~joining_thread()
+      // next, look in the injection queue
+      // take a batch of tasks to amortize the cost of locking the injection queue
+      // these tasks are executed by this worker unless other workers steal them first
+      unique_function<void()> batch[injection_batch_size];
+      size_t num_injected = injected_tasks_.try_steal_front_n(batch, injection_batch_size);
+      if(num_injected > 0)
       {
-        if(joinable()) join();
+        task = std::move(batch[0]);
+
+        if(num_injected > 1)
+        {
+          worker_tasks_[worker_idx]->push_back_n(batch + 1, batch + num_injected);
+
+          // let a sleeping worker know there is something to steal
+          wake_one();
+        }
+
+        return true;
       }
-    };
 
-  public:
-    explicit thread_pool(size_t num_threads = std::max(1u, std::thread::hardware_concurrency()))
-    {
-      for(size_t i = 0; i < num_threads; ++i)
+      // finally, try to steal from other workers, starting from a random victim
+      size_t num_workers = worker_tasks_.size();
+      if(num_workers > 1)
       {
-        threads_.emplace_back([this]
+        // xorshift
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+
+        size_t first_victim = random_state % num_workers;
+
+        for(size_t i = 0; i < num_workers; ++i)
         {
-          work();
-        });
+          size_t victim = (first_victim + i) % num_workers;
+
+          if(victim != worker_idx && worker_tasks_[victim]->try_steal_front(task))
+          {
+            return true;
+          }
+        }
       }
+
+      return false;
     }
-    
-    ~thread_pool()
+
+    // returns whether there is any task waiting in the injection queue or some worker's deque
+    inline bool has_queued_tasks() const
     {
-      tasks_.close();
-      threads_.clear();
+      if(!injected_tasks_.empty() || !high_priority_tasks_.empty()) return true;
+
+      for(const auto& d : worker_tasks_)
+      {
+        if(!d->empty()) return true;
+      }
+
+      return false;
     }
 
-    template<class Function,
-             class = result_of_t<Function()>>
-    inline void submit(Function&& f)
+    // if fewer than max_spinning_workers_ workers are spinning, spins until a task arrives in the calling
+    // worker's mailbox or some queue, or until spin_duration_ns_ elapses
+    // returns whether the worker should look for work again rather than sleep
+    // a task received through the mailbox is returned through task
+    inline bool spin_for_work(size_t worker_idx, unique_function<void()>& task)
     {
-      auto is_this_thread = [=](const joining_thread& t)
+      size_t num_spinning = num_spinning_.load();
+      do
       {
-        return t.get_id() == std::this_thread::get_id();
-      };
+        if(num_spinning >= max_spinning_workers_.load()) return false;
+      }
+      while(!num_spinning_.compare_exchange_weak(num_spinning, num_spinning + 1));
 
-      // guard against self-submission which may result in deadlock
-      // XXX it might be faster to compare this to a thread_local variable
-      if(std::find_if(threads_.begin(), threads_.end(), is_this_thread) == threads_.end())
+      mailbox& box = mailboxes_[worker_idx];
+      box.state.store(mailbox::open);
+
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(spin_duration_ns_.load());
+
+      exponential_backoff backoff;
+      bool found_queued_task = false;
+
+      while(box.state.load(std::memory_order_acquire) == mailbox::open &&
+            !(found_queued_task = has_queued_tasks()) &&
+            std::chrono::steady_clock::now() < deadline)
       {
-        tasks_.emplace(std::forward<Function>(f));
+        backoff.pause();
       }
-      else
+
+      // close the mailbox
+      // if a submitter has claimed it first, wait for the task to arrive
+      int expected = mailbox::open;
+      bool received_task = !box.state.compare_exchange_strong(expected, mailbox::closed);
+
+      if(received_task)
       {
-        // the submitting thread is part of this pool so execute immediately 
-        std::forward<Function>(f)();
+        while(box.state.load(std::memory_order_acquire) != mailbox::full)
+        {
+          cpu_relax();
+        }
+
+        task = std::move(box.task);
+        box.task = nullptr;
+
+        // the submitter's claim of the mailbox in try_deliver() observes our next store of open,
+        // so it also observes that the mailbox's previous task has moved out
+        box.state.store(mailbox::closed, std::memory_order_relaxed);
       }
+
+      --num_spinning_;
+
+      return received_task || found_queued_task;
     }
 
-    inline size_t size() const
+    // hands the task to a spinning worker through the worker's mailbox
+    // returns false, leaving the task in place, if no worker's mailbox is open
+    inline bool try_deliver(unique_function<void()>& task)
     {
-      return threads_.size();
+      if(num_spinning_.load() == 0) return false;
+
+      for(size_t i = 0; i < num_slots_; ++i)
+      {
+        mailbox& box = mailboxes_[i];
+
+        int expected = mailbox::open;
+        if(box.state.load(std::memory_order_relaxed) == mailbox::open &&
+           box.state.compare_exchange_strong(expected, mailbox::filling))
+        {
+          box.task = std::move(task);
+          box.state.store(mailbox::full, std::memory_order_release);
+          return true;
+        }
+      }
+
+      return false;
     }
 
-    template<class Function, class... Args>
-    std::future<result_of_t<Function(Args...)>>
-      async(Function&& f, Args&&... args)
+    // puts the calling worker to sleep until there may be work to do
+    // returns false if the pool is stopping and no work remains, or if the worker has retired
+    inline bool wait_for_work(size_t worker_idx)
     {
-      // bind f & args together
-      auto g = std::bind(std::forward<Function>(f), std::forward<Args>(args)...);
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
 
-      using result_type = result_of_t<Function(Args...)>;
-
-      // create a packaged task
-      std::packaged_task<result_type()> task(std::move(g));
+      // announce that we are about to sleep before checking for work one last time
+      // wake_one() increments a queue's size before it reads num_sleeping_,
+      // so either we observe the new task below, or the submitter observes us and notifies
+      ++num_sleeping_;
 
-      // get the packaged task's future so we can return it at the end
-      auto result_future = task.get_future();
+      while(!is_stopping_ && !has_queued_tasks())
+      {
+        if(num_running_.load() > max_running_threads())
+        {
+          // we are a spare worker which is no longer needed
+          --num_sleeping_;
+          --num_running_;
+          is_running_[worker_idx] = false;
+          return false;
+        }
+        else if(num_running_.load() > min_threads_)
+        {
+          if(wake_up_.wait_for(lock, idle_timeout_) == std::cv_status::timeout &&
+             !is_stopping_ && !has_queued_tasks() && num_running_.load() > min_threads_)
+          {
+            // retire
+            // a submitter which observed us sleeping acquires the lock after we release it,
+            // finds us gone, and starts another worker
+            --num_sleeping_;
+            --num_running_;
+            is_running_[worker_idx] = false;
+            return false;
+          }
+        }
+        else
+        {
+          wake_up_.wait(lock);
+        }
+      }
 
-      // move the packaged task into the thread pool
-      submit(std::move(task));
+      --num_sleeping_;
 
-      return std::move(result_future);
+      return !is_stopping_ || has_queued_tasks();
     }
 
+    // the number of workers which may run at once, including spares taking the place of blocked workers
+    inline size_t max_running_threads() const
+    {
+      return std::min(max_threads_ + num_blocked_.load(), num_slots_);
+    }
 
-  private:
-    inline void work()
+    inline void wake_one()
     {
-      unique_function<void()> task;
+      // when every worker is running and none sleeps, some worker will find the task before it sleeps
+      if(num_sleeping_.load() == 0 && num_running_.load() >= max_running_threads()) return;
 
-      while(tasks_.wait_and_pop(task))
+      // acquire the lock to ensure a sleeping worker is actually waiting on wake_up_
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+
+      if(num_sleeping_.load() > 0)
       {
-        task();
+        lock.unlock();
+        wake_up_.notify_one();
       }
+      else if(!is_stopping_ && num_running_.load() < max_running_threads())
+      {
+        // no worker is idle, so start another
+        auto slot = std::find(is_running_.begin(), is_running_.end(), false);
+        start_worker(slot - is_running_.begin());
+      }
+    }
+
+    // starts a worker in the given slot
+    // precondition: sleep_mutex_ is locked
+    inline void start_worker(size_t i)
+    {
+      // a worker which previously occupied this slot has retired, so wait for its thread to finish
+      if(threads_[i].joinable())
+      {
+        threads_[i].join();
+      }
+
+      is_running_[i] = true;
+      ++num_running_;
+
+      threads_[i] = joining_thread([=]
+      {
+        thread_placement_detail::bind_this_thread(worker_cpus_[i]);
+
+        this_worker::current_pool() = this;
+
+        if(mode_ == thread_pool_mode::work_stealing)
+        {
+          steal_work(i);
+        }
+        else
+        {
+          work();
+        }
+      });
+    }
+
+    // the state of the worker executing in the current thread in thread_pool_mode::work_stealing
+    struct worker_state
+    {
+      size_t index;
+      std::uint32_t random_state;
+
+      // the bulk launch of this pool whose chunks the worker is executing, if any
+      bulk_task_base* current_bulk_task;
+    };
+
+    // a thread is a worker of at most one pool, and records only that pool's bulk launches,
+    // so this state need not be stored per pool
+    static worker_state& this_worker_state()
+    {
+      static thread_local worker_state result = {0, 1, nullptr};
+      return result;
     }
 
-    agency::detail::concurrent_queue<unique_function<void()>> tasks_;
+    placement_policy placement_;
+    std::vector<std::vector<int>> worker_cpus_;
+
+    TaskAllocator task_allocator_;
+
+    thread_pool_mode mode_;
+
+    // the queue used in thread_pool_mode::shared_queue
+    TaskQueue<unique_function<void()>> tasks_;
+
+    // the lane of high priority tasks, used in both modes
+    task_deque high_priority_tasks_;
+
+    // the queues used in thread_pool_mode::work_stealing
+    task_deque injected_tasks_;
+    std::vector<std::unique_ptr<task_deque>> worker_tasks_;
+
+    // state used to put idle workers to sleep in thread_pool_mode::work_stealing
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_up_;
+    // the elasticity of the pool
+    // a pool which is not elastic has min_threads_ == max_threads_
+    const size_t min_threads_;
+    const size_t max_threads_;
+    const std::chrono::milliseconds idle_timeout_;
+
+    // the number of worker slots, including those reserved for spare workers
+    const size_t num_slots_;
+
+    bool is_stopping_;
+    std::atomic<size_t> num_sleeping_;
+    std::atomic<size_t> num_running_;
+    std::atomic<size_t> num_blocked_;
+
+    // the slots of the workers
+    // a slot whose worker has retired may hold a thread which has not yet been joined
     std::vector<joining_thread> threads_;
+    std::vector<bool> is_running_;
+
+    // state used by spinning workers in thread_pool_mode::work_stealing
+    aligned_unique_array<mailbox> mailboxes_;
+    std::atomic<size_t> max_spinning_workers_;
+    std::atomic<std::int64_t> spin_duration_ns_;
+    std::atomic<size_t> num_spinning_;
 };
 
 
 
+template<template<class> class TaskQueue, class TaskAllocator>
+constexpr size_t basic_thread_pool<TaskQueue,TaskAllocator>::max_bulk_chunk_size;
+
+
+using thread_pool = basic_thread_pool<>;
+
+
+// the system thread pool is elastic, so processes which never submit work never start its threads
+// its limits may be configured with the environment variables read by thread_pool_elasticity::from_environment()
+// and its workers spin as configured by the environment variables read by thread_pool_spinning::from_environment()
 inline thread_pool& system_thread_pool()
 {
-  static thread_pool resource;
+  static thread_pool resource(thread_pool_elasticity::from_environment());
+
+  static bool configured = (resource.set_spinning(thread_pool_spinning::from_environment()), true);
+  (void)configured;
+
   return resource;
 }
 
 
+// thread_pool_executor creates agents on a thread_pool
+// a default-constructed thread_pool_executor creates agents on the system_thread_pool
+//
+// Executors of the same pool share its workers. To isolate one kind of work from another, give each
+// its own pool. Alternatively, an executor's concurrency quota limits the number of workers any single
+// bulk launch may occupy, so that one tenant's launch cannot starve the other tenants of a shared pool.
 class thread_pool_executor
 {
   public:
+    constexpr thread_pool_executor()
+      : pool_(nullptr),
+        concurrency_quota_(0),
+        priority_(task_priority::normal)
+    {}
+
+    // the pool must outlive the executor and all work it creates
+    // a concurrency_quota of zero means that launches may occupy every worker of the pool
+    explicit thread_pool_executor(thread_pool& pool, size_t concurrency_quota = 0)
+      : pool_(&pool),
+        concurrency_quota_(concurrency_quota),
+        priority_(task_priority::normal)
+    {}
+
+    thread_pool& pool() const
+    {
+      return pool_ ? *pool_ : system_thread_pool();
+    }
+
+    // the maximum number of the pool's workers which agents created by a single bulk launch occupy at once
+    size_t concurrency_quota() const
+    {
+      return concurrency_quota_ ? std::min(concurrency_quota_, pool().size()) : pool().size();
+    }
+
     constexpr static bulk_guarantee_t::parallel_t query(bulk_guarantee_t)
     {
       return bulk_guarantee.parallel;
     }
 
-    friend constexpr bool operator==(const thread_pool_executor&, const thread_pool_executor&) noexcept
+    // the placement of the pool's worker threads
+    // callers may use it with placement_policy::worker_cpus() to partition data to match the workers
+    const placement_policy& query(thread_placement_t) const
+    {
+      return pool().placement();
+    }
+
+    // returns an executor whose work executes in the pool's lane for the given priority
+    thread_pool_executor require(const priority_t::high_t&) const
+    {
+      thread_pool_executor result = *this;
+      result.priority_ = task_priority::high;
+      return result;
+    }
+
+    thread_pool_executor require(const priority_t::normal_t&) const
+    {
+      thread_pool_executor result = *this;
+      result.priority_ = task_priority::normal;
+      return result;
+    }
+
+    bool query(const priority_t::high_t&) const
+    {
+      return priority_ == task_priority::high;
+    }
+
+    bool query(const priority_t::normal_t&) const
+    {
+      return priority_ == task_priority::normal;
+    }
+
+    friend bool operator==(const thread_pool_executor& a, const thread_pool_executor& b) noexcept
     {
-      // currently, all thread_pool_executors compare equal because they all refer to the
-      // system_thread_pool
-      return true;
+      return &a.pool() == &b.pool() && a.concurrency_quota() == b.concurrency_quota() && a.priority_ == b.priority_;
     }
 
-    friend constexpr bool operator!=(const thread_pool_executor& a, const thread_pool_executor& b) noexcept
+    friend bool operator!=(const thread_pool_executor& a, const thread_pool_executor& b) noexcept
     {
       return !(a == b);
     }
 
+    template<class T>
+    using future = agency::future<T>;
+
   private:
-    // this deleter fulfills a promise just before
-    // it deletes its argument
-    template<class ResultType>
-    struct fulfill_promise_and_delete
+    // the state shared by the agents created by a single call to bulk_then_execute()
+    // the promise is fulfilled with the result when the final agent releases its reference to the state
+    template<class ResultType, class SharedArgType>
+    struct bulk_state
     {
-      std::shared_ptr<std::promise<ResultType>> shared_promise_ptr;
+      agency::promise<ResultType> promise;
+      ResultType result;
+      SharedArgType shared_arg;
+      std::exception_ptr exception;
 
-      void operator()(ResultType* ptr_to_result)
-      {
-        // move the result object into the promise
-        shared_promise_ptr->set_value(std::move(*ptr_to_result));
+      template<class ResultFactory, class SharedFactory>
+      bulk_state(ResultFactory result_factory, SharedFactory shared_factory)
+        : result(result_factory()),
+          shared_arg(shared_factory())
+      {}
 
-        // delete the pointer
-        delete ptr_to_result;
+      ~bulk_state()
+      {
+        if(exception)
+        {
+          promise.set_exception(exception);
+        }
+        else
+        {
+          promise.set_value(std::move(result));
+        }
       }
     };
     
 
+    // submits n agents to the pool once the predecessor becomes ready
+    // rather than submitting agents which wait on the predecessor, we defer submission
+    // so that no thread in the pool is blocked while the predecessor is not ready
+    //
+    // the thread pool destroys agent after the final agent completes,
+    // which releases the agent's reference to the bulk_state and fulfills the promise
+    template<class SharedFuture, class BulkState, class Function>
+    void bulk_submit_when_ready(const SharedFuture& predecessor, const std::shared_ptr<BulkState>& state, Function agent, size_t n) const
+    {
+      thread_pool* pool = &this->pool();
+      size_t concurrency_quota = this->concurrency_quota();
+      task_priority priority = priority_;
+
+      detail::invoke_when_ready(predecessor, [=]
+      {
+        try
+        {
+          predecessor.get();
+        }
+        catch(...)
+        {
+          // an exceptional predecessor creates no agents and its exception becomes the result
+          state->exception = std::current_exception();
+          return;
+        }
+
+        pool->bulk_submit(agent, n, concurrency_quota, priority);
+      },
+      submit_task{pool, priority});
+    }
+
+
+    // fulfills the promise with the result of f(), or with the exception f() throws
+    template<class Function>
+    static void invoke_and_set_value(agency::promise<void>& promise, Function&& f)
+    {
+      try
+      {
+        std::forward<Function>(f)();
+        promise.set_value();
+      }
+      catch(...)
+      {
+        promise.set_exception(std::current_exception());
+      }
+    }
+
+    template<class T, class Function>
+    static void invoke_and_set_value(agency::promise<T>& promise, Function&& f)
+    {
+      try
+      {
+        promise.set_value(std::forward<Function>(f)());
+      }
+      catch(...)
+      {
+        promise.set_exception(std::current_exception());
+      }
+    }
+
+
+    // invokes f with the result of a ready shared future
+    template<class Function, class SharedFuture,
+             __AGENCY_REQUIRES(!std::is_void<future_result_t<SharedFuture>>::value)
+            >
+    static result_of_continuation_t<Function, SharedFuture> invoke_continuation(Function& f, const SharedFuture& predecessor)
+    {
+      using predecessor_type = future_result_t<SharedFuture>;
+      return f(const_cast<predecessor_type&>(predecessor.get()));
+    }
+
+    template<class Function, class SharedFuture,
+             __AGENCY_REQUIRES(std::is_void<future_result_t<SharedFuture>>::value)
+            >
+    static result_of_continuation_t<Function, SharedFuture> invoke_continuation(Function& f, const SharedFuture& predecessor)
+    {
+      predecessor.get();
+      return f();
+    }
+
+
+    // the task submitted by then_execute() once its predecessor is ready
+    template<class Result, class Function, class SharedFuture>
+    struct continuation_task
+    {
+      Function f;
+      SharedFuture predecessor;
+      agency::promise<Result> promise;
+
+      void operator()()
+      {
+        invoke_and_set_value(promise, [&]
+        {
+          return invoke_continuation(f, predecessor);
+        });
+      }
+    };
+
+
+    // submits a task to the pool
+    // invoke_when_ready() submits its waits on predecessors other than agency::shared_future this way
+    struct submit_task
+    {
+      thread_pool* pool;
+      task_priority priority;
+
+      template<class Task>
+      void operator()(Task task) const
+      {
+        pool->submit(std::move(task), priority);
+      }
+    };
+
+
+    // submits a continuation_task to the pool
+    // this is the function then_execute() arranges to invoke once the predecessor is ready
+    template<class Task>
+    struct submit_continuation_task
+    {
+      thread_pool* pool;
+      task_priority priority;
+      Task task;
+
+      void operator()()
+      {
+        pool->submit(std::move(task), priority);
+      }
+    };
+
+
+  public:
+    // twoway_execute() submits a single task which invokes f and fulfills the returned future
+    // rather than adapting bulk_then_execute(), it allocates only the future's state,
+    // and the task itself is stored without allocation when f is small
+    template<class Function>
+    future<result_of_t<decay_t<Function>()>>
+      twoway_execute(Function&& f) const
+    {
+      using result_type = result_of_t<decay_t<Function>()>;
+
+      agency::promise<result_type> promise;
+      future<result_type> result_future = promise.get_future();
+
+      pool().submit(invocation_task<result_type, decay_t<Function>>{std::forward<Function>(f), std::move(promise)}, priority_);
+
+      return result_future;
+    }
+
+
+    // then_execute() submits a single task which invokes f with the predecessor's result once it is ready
+    template<class Function, class Future>
+    future<result_of_continuation_t<decay_t<Function>, Future>>
+      then_execute(Function&& f, Future& predecessor) const
+    {
+      using result_type = result_of_continuation_t<decay_t<Function>, Future>;
+      using shared_future_type = decltype(future_traits<Future>::share(predecessor));
+      using task_type = continuation_task<result_type, decay_t<Function>, shared_future_type>;
+
+      agency::promise<result_type> promise;
+      future<result_type> result_future = promise.get_future();
+
+      shared_future_type shared_predecessor = future_traits<Future>::share(predecessor);
+
+      detail::invoke_when_ready(shared_predecessor, submit_continuation_task<task_type>{
+        &pool(),
+        priority_,
+        task_type{std::forward<Function>(f), shared_predecessor, std::move(promise)}
+      },
+      submit_task{&pool(), priority_});
+
+      return result_future;
+    }
+
+  private:
+    // the task submitted by twoway_execute()
+    template<class Result, class Function>
+    struct invocation_task
+    {
+      Function f;
+      agency::promise<Result> promise;
+
+      void operator()()
+      {
+        invoke_and_set_value(promise, f);
+      }
+    };
+
   public:
     // this is the overload of bulk_then_execute for non-void Future
     template<class Function, class Future, class ResultFactory, class SharedFactory,
              __AGENCY_REQUIRES(!std::is_void<future_result_t<Future>>::value)
             >
-    std::future<
+    future<
       result_of_t<ResultFactory()>
     >
       bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
     {
       using result_type = result_of_t<ResultFactory()>;
+      using shared_arg_type = result_of_t<SharedFactory()>;
 
-      // create a shared promise to fulfill the result
-      auto shared_promise_ptr = std::make_shared<std::promise<result_type>>();
-
-      // get the shared promise's future
-      auto result_future = shared_promise_ptr->get_future();
-
-      // create a deleter which fulfills the promise with the result and then deletes the result
-      fulfill_promise_and_delete<result_type> deleter{std::move(shared_promise_ptr)};
-
-      // create the shared state for the result
-      // note that we use our special deleter with this state
-      auto shared_result_ptr = std::shared_ptr<result_type>(new result_type(result_factory()), std::move(deleter));
+      // create the state shared by all agents
+      auto state = std::make_shared<bulk_state<result_type, shared_arg_type>>(result_factory, shared_factory);
 
-      // create the shared state for the shared parameter
-      using shared_arg_type = result_of_t<SharedFactory()>;
-      auto shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+      // get the promise's future
+      auto result_future = state->promise.get_future();
 
       // share the incoming future
       auto shared_predecessor = future_traits<Future>::share(predecessor);
 
-      // submit n tasks to the thread pool
-      for(size_t idx = 0; idx < n; ++idx)
+      // create the function each agent invokes
+      auto agent = [=](size_t idx) mutable
       {
-        system_thread_pool().submit([=]() mutable
-        {
 // nvcc makes this lambda's constructors __host__ __device__ when
 // any of its captures' constructors are __host__ __device__. This causes nvcc
 // to emit warnings about a __host__ __device__ function calling __host__ functions 
 // this #ifndef works around this problem
 #ifndef __CUDA_ARCH__
-          // get the predecessor future's result
-          using predecessor_type = future_result_t<Future>;
-          predecessor_type& predecessor_arg = const_cast<predecessor_type&>(shared_predecessor.get());
-
-          // call the user's function
-          f(idx, predecessor_arg, *shared_result_ptr, *shared_arg_ptr);
-
-          // we explicitly release shared_result_ptr because even though this
-          // lambda's invocation is complete, the lambda's lifetime
-          // (and therefore shared_result_ptr's lifetime) is not necessarily complete
-          // this .reset() is what fulfills the promise via shared_result_ptr's deleter
-          shared_result_ptr.reset();
+        // get the predecessor future's result
+        // the predecessor is ready by the time any agent executes
+        using predecessor_type = future_result_t<Future>;
+        predecessor_type& predecessor_arg = const_cast<predecessor_type&>(shared_predecessor.get());
+
+        // call the user's function
+        f(idx, predecessor_arg, state->result, state->shared_arg);
 #endif
-        });
-      }
+      };
+
+      bulk_submit_when_ready(shared_predecessor, state, agent, n);
 
       // return the result future
       return std::move(result_future);
@@ -237,65 +1616,71 @@ class thread_pool_executor
     template<class Function, class Future, class ResultFactory, class SharedFactory,
              __AGENCY_REQUIRES(std::is_void<future_result_t<Future>>::value)
             >
-    std::future<
+    future<
       result_of_t<ResultFactory()>
     >
       bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
     {
       using result_type = result_of_t<ResultFactory()>;
+      using shared_arg_type = result_of_t<SharedFactory()>;
 
-      // create a shared promise to fulfill the result
-      auto shared_promise_ptr = std::make_shared<std::promise<result_type>>();
-
-      // get the shared promise's future
-      auto result_future = shared_promise_ptr->get_future();
-
-      // create a deleter which fulfills the promise with the result and then deletes the result
-      fulfill_promise_and_delete<result_type> deleter{std::move(shared_promise_ptr)};
-
-      // create the shared state for the result
-      auto shared_result_ptr = std::shared_ptr<result_type>(new result_type(result_factory()), std::move(deleter));
+      // create the state shared by all agents
+      auto state = std::make_shared<bulk_state<result_type, shared_arg_type>>(result_factory, shared_factory);
 
-      // create the shared state for the shared parameter
-      using shared_arg_type = result_of_t<SharedFactory()>;
-      auto shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+      // get the promise's future
+      auto result_future = state->promise.get_future();
 
       // share the incoming future
       auto shared_predecessor = future_traits<Future>::share(predecessor);
 
-      // submit n tasks to the thread pool
-      for(size_t idx = 0; idx < n; ++idx)
+      // create the function each agent invokes
+      auto agent = [=](size_t idx) mutable
       {
-        system_thread_pool().submit([=]() mutable
-        {
 // nvcc makes this lambda's constructors __host__ __device__ when
 // any of its captures' constructors are __host__ __device__. This causes nvcc
 // to emit warnings about a __host__ __device__ function calling __host__ functions 
 // this #ifndef works around this problem
 #ifndef __CUDA_ARCH__
-          // wait on the predecessor future
-          shared_predecessor.wait();
-
-          // call the user's function
-          f(idx, *shared_result_ptr, *shared_arg_ptr);
-
-          // we explicitly release shared_result_ptr because even though this
-          // lambda's invocation is complete, the lambda's lifetime
-          // (and therefore shared_result_ptr's lifetime) is not necessarily complete
-          // this .reset() is what fulfills the promise via shared_result_ptr's deleter
-          shared_result_ptr.reset();
+        // call the user's function
+        f(idx, state->result, state->shared_arg);
 #endif
-        });
-      }
+      };
+
+      bulk_submit_when_ready(shared_predecessor, state, agent, n);
 
       // return the result future
       return std::move(result_future);
     }
 
+    // bulk_sync_execute() creates n agents and returns their result once they are complete
+    // the calling thread executes agents alongside the pool's workers, and no future is created
+    template<class Function, class ResultFactory, class SharedFactory>
+    result_of_t<ResultFactory()>
+      bulk_sync_execute(Function f, size_t n, ResultFactory result_factory, SharedFactory shared_factory) const
+    {
+      auto result = result_factory();
+      auto shared_arg = shared_factory();
+
+      pool().bulk_invoke([&](size_t idx)
+      {
+        f(idx, result, shared_arg);
+      },
+      n,
+      concurrency_quota(),
+      priority_);
+
+      return result;
+    }
+
     size_t unit_shape() const
     {
-      return system_thread_pool().size();
+      return concurrency_quota();
     }
+
+  private:
+    thread_pool* pool_;
+    size_t concurrency_quota_;
+    task_priority priority_;
 };
 
 
@@ -4,6 +4,7 @@
 #include <agency/experimental/variant.hpp>
 #include <agency/detail/type_traits.hpp>
 #include <agency/detail/type_list.hpp>
+#include <agency/detail/concurrency/arrive_and_wait.hpp>
 
 
 namespace agency
@@ -110,6 +111,33 @@ class variant_barrier : private agency::experimental::variant<Barrier, Barriers.
     {
       agency::experimental::visit(arrive_and_wait_visitor{}, static_cast<super_t&>(*this));
     }
+
+  private:
+    struct indexed_arrive_and_wait_visitor
+    {
+      size_t index;
+
+      __agency_exec_check_disable__
+      template<class T>
+      __AGENCY_ANNOTATION
+      void operator()(T& self) const
+      {
+        agency::detail::arrive_and_wait(self, index);
+      }
+
+      __AGENCY_ANNOTATION
+      void operator()(agency::experimental::monostate) const
+      {
+        assert(0);
+      }
+    };
+
+  public:
+    __AGENCY_ANNOTATION
+    void arrive_and_wait(size_t index)
+    {
+      agency::experimental::visit(indexed_arrive_and_wait_visitor{index}, static_cast<super_t&>(*this));
+    }
 };
 
 
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// work_stealing_deque is a double-ended queue of work items owned by a single worker thread.
+// The owner pushes and pops at the back, while other threads steal from the front.
+//
+// Each deque is guarded by its own mutex, so the only contention on a deque is between its owner
+// and the occasional thief. The number of items is also tracked in an atomic counter so that
+// thieves may skip empty victims without acquiring their lock.
+template<class T>
+class work_stealing_deque
+{
+  public:
+    work_stealing_deque()
+      : size_(0)
+    {}
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+
+    template<class... Args>
+    void emplace_back(Args&&... args)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      items_.emplace_back(std::forward<Args>(args)...);
+      ++size_;
+    }
+
+    void push_back(T&& item)
+    {
+      emplace_back(std::move(item));
+    }
+
+    // moves each item in [first, last) into the back of this deque
+    // while holding the lock only once
+    template<class Iterator>
+    void push_back_n(Iterator first, Iterator last)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      for(; first != last; ++first)
+      {
+        items_.emplace_back(std::move(*first));
+        ++size_;
+      }
+    }
+
+    // pops the most recently pushed item
+    // this should only be called by the owner
+    bool try_pop_back(T& item)
+    {
+      if(empty()) return false;
+
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if(items_.empty()) return false;
+
+      item = std::move(items_.back());
+      items_.pop_back();
+      --size_;
+
+      return true;
+    }
+
+    // steals the least recently pushed item
+    bool try_steal_front(T& item)
+    {
+      if(empty()) return false;
+
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if(items_.empty()) return false;
+
+      item = std::move(items_.front());
+      items_.pop_front();
+      --size_;
+
+      return true;
+    }
+
+    // steals up to max_items of the least recently pushed items and
+    // writes them to result
+    // returns the number of items stolen
+    template<class OutputIterator>
+    size_t try_steal_front_n(OutputIterator result, size_t max_items)
+    {
+      if(empty()) return 0;
+
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      size_t num_stolen = 0;
+      for(; num_stolen < max_items && !items_.empty(); ++num_stolen, ++result)
+      {
+        *result = std::move(items_.front());
+        items_.pop_front();
+        --size_;
+      }
+
+      return num_stolen;
+    }
+
+    // the result of size() and empty() is only a snapshot and may be stale
+    // by the time it is observed
+    size_t size() const
+    {
+      return size_.load();
+    }
+
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+  private:
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::atomic<size_t> size_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/memory/detail/unique_ptr.hpp>
 #include <stdexcept>
 #include <cassert>
 #include <utility>
 #include <type_traits>
 #include <memory>
+#include <new>
+#include <cstddef>
 
 
 namespace agency
@@ -47,25 +48,47 @@ inline void throw_bad_function_call()
 template<class>
 class unique_function;
 
+// unique_function is a move-only, type-erased function wrapper
+//
+// Callables which are small enough and nothrow move constructible are stored inline, so wrapping
+// them does not allocate. Larger callables are stored in a node obtained from an allocator, which
+// may be supplied with the std::allocator_arg constructors. The node's allocator is stored alongside
+// the callable and deallocates the node when the unique_function is destroyed.
 template<class Result, class... Args>
 class unique_function<Result(Args...)>
 {
   public:
     using result_type = Result;
 
-    unique_function() = default;
+    // the size of the largest callable stored without allocation
+    // with the two function pointers below, a unique_function occupies a single 64B cache line
+    static constexpr std::size_t inline_capacity = 6 * sizeof(void*);
+
+    __AGENCY_ANNOTATION
+    unique_function()
+      : unique_function(nullptr)
+    {}
 
     __AGENCY_ANNOTATION
     unique_function(std::nullptr_t)
-      : f_ptr_(nullptr)
+      : invoke_(nullptr),
+        manage_(nullptr)
     {}
 
-    unique_function(unique_function&& other) = default;
+    __AGENCY_ANNOTATION
+    unique_function(unique_function&& other) noexcept
+      : unique_function(nullptr)
+    {
+      move_from(other);
+    }
 
-    template<class Function>
+    template<class Function,
+             class = typename std::enable_if<
+               !std::is_same<typename std::decay<Function>::type, unique_function>::value
+             >::type>
     __AGENCY_ANNOTATION
     unique_function(Function&& f)
-      : unique_function(std::allocator_arg, default_allocator<typename std::decay<Function>::type>{}, std::forward<Function>(f))
+      : unique_function(std::allocator_arg, std::allocator<typename std::decay<Function>::type>(), std::forward<Function>(f))
     {}
 
     template<class Alloc>
@@ -83,16 +106,46 @@ class unique_function<Result(Args...)>
     template<class Alloc>
     __AGENCY_ANNOTATION
     unique_function(std::allocator_arg_t, const Alloc&, unique_function&& other)
-      : f_ptr_(std::move(other.f_ptr_))
+      : unique_function(std::move(other))
     {}
 
-    template<class Alloc, class Function>
+    template<class Alloc, class Function,
+             class = typename std::enable_if<
+               !std::is_same<typename std::decay<Function>::type, unique_function>::value
+             >::type>
     __AGENCY_ANNOTATION
     unique_function(std::allocator_arg_t, const Alloc& alloc, Function&& f)
-      : f_ptr_(allocate_function_pointer(alloc, std::forward<Function>(f)))
-    {}
+      : unique_function(nullptr)
+    {
+      using function_type = typename std::decay<Function>::type;
+
+      construct(is_stored_inline<function_type>(), alloc, std::forward<Function>(f));
+    }
+
+    __AGENCY_ANNOTATION
+    ~unique_function()
+    {
+      reset();
+    }
 
-    unique_function& operator=(unique_function&& other) = default;
+    __AGENCY_ANNOTATION
+    unique_function& operator=(unique_function&& other) noexcept
+    {
+      if(this != &other)
+      {
+        reset();
+        move_from(other);
+      }
+
+      return *this;
+    }
+
+    __AGENCY_ANNOTATION
+    unique_function& operator=(std::nullptr_t)
+    {
+      reset();
+      return *this;
+    }
 
     __AGENCY_ANNOTATION
     Result operator()(Args... args) const
@@ -102,145 +155,199 @@ class unique_function<Result(Args...)>
         unique_function_detail::throw_bad_function_call();
       }
 
-      return (*f_ptr_)(args...);
+      // like std::function, invoking a const unique_function may mutate its target
+      return invoke_(const_cast<void*>(static_cast<const void*>(&storage_)), std::forward<Args>(args)...);
     }
 
     __AGENCY_ANNOTATION
     operator bool () const
     {
-      return f_ptr_;
+      return invoke_ != nullptr;
     }
 
-  private:
-    // this is the abstract base class for a type
-    // which is both
-    // 1. callable like a function and
-    // 2. deallocates itself inside its destructor
-    struct callable_self_deallocator_base
+    // returns whether a callable of type Function is stored without allocation
+    template<class Function>
+    __AGENCY_ANNOTATION
+    static constexpr bool stores_inline()
     {
-      using self_deallocate_function_type = void(*)(callable_self_deallocator_base*);
+      return is_stored_inline<Function>::value;
+    }
 
-      self_deallocate_function_type self_deallocate_function;
+  private:
+    enum class operation { move, destroy };
 
-      template<class Function>
-      __AGENCY_ANNOTATION
-      callable_self_deallocator_base(Function callback)
-        : self_deallocate_function(callback)
-      {}
+    using storage_type = typename std::aligned_storage<inline_capacity, alignof(std::max_align_t)>::type;
+    using invoke_function_type = Result(*)(void*, Args&&...);
+    using manage_function_type = void(*)(operation, void*, void*);
+
+    // a callable is stored inline if it fits and if moving it cannot throw,
+    // which keeps moving a unique_function noexcept
+    template<class Function>
+    struct is_stored_inline : std::integral_constant<
+      bool,
+      sizeof(Function) <= inline_capacity &&
+      alignof(std::max_align_t) % alignof(Function) == 0 &&
+      std::is_nothrow_move_constructible<Function>::value
+    >
+    {};
 
+    template<class Function>
+    struct inline_callable
+    {
+      __agency_exec_check_disable__
       __AGENCY_ANNOTATION
-      virtual ~callable_self_deallocator_base()
+      static Result invoke(void* storage, Args&&... args)
       {
-        self_deallocate_function(this);
+        return (*static_cast<Function*>(storage))(std::forward<Args>(args)...);
       }
 
+      __agency_exec_check_disable__
       __AGENCY_ANNOTATION
-      virtual Result operator()(Args... args) const = 0;
+      static void manage(operation op, void* from, void* to)
+      {
+        Function* f = static_cast<Function*>(from);
+
+        if(op == operation::move)
+        {
+          ::new(to) Function(std::move(*f));
+        }
+
+        f->~Function();
+      }
     };
 
+    // a heap_callable is the node which stores a callable too large to store inline
+    // the node's allocator deallocates the node
     template<class Function, class Alloc>
-    struct callable : callable_self_deallocator_base
+    struct heap_callable
     {
-      using super_t = callable_self_deallocator_base;
-      using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<callable>;
+      using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<heap_callable>;
 
-      mutable Function f_;
-
-      __agency_exec_check_disable__
-      ~callable() = default;
+      allocator_type alloc;
+      Function f;
 
       __agency_exec_check_disable__
-      template<class OtherFunction,
-               class = typename std::enable_if<
-                 std::is_constructible<Function,OtherFunction&&>::value
-               >::type>
+      template<class OtherFunction>
       __AGENCY_ANNOTATION
-      callable(const Alloc&, OtherFunction&& f)
-        : super_t(deallocate),
-          f_(std::forward<OtherFunction>(f))
+      heap_callable(const allocator_type& alloc, OtherFunction&& f)
+        : alloc(alloc),
+          f(std::forward<OtherFunction>(f))
       {}
 
-      __agency_exec_check_disable__
       __AGENCY_ANNOTATION
-      virtual Result operator()(Args... args) const
+      static heap_callable*& pointer(void* storage)
       {
-        return f_(args...);
+        return *static_cast<heap_callable**>(storage);
       }
 
       __agency_exec_check_disable__
       __AGENCY_ANNOTATION
-      static void deallocate(callable_self_deallocator_base* ptr)
+      static Result invoke(void* storage, Args&&... args)
       {
-        // upcast to the right type of pointer
-        callable* self = static_cast<callable*>(ptr);
+        return pointer(storage)->f(std::forward<Args>(args)...);
+      }
 
-        // XXX seems like creating a new allocator here is cheating
-        //     we should use some member allocator, but it's not clear where to put it
-        allocator_type alloc_;
-        alloc_.deallocate(self, 1);
+      __agency_exec_check_disable__
+      __AGENCY_ANNOTATION
+      static void manage(operation op, void* from, void* to)
+      {
+        heap_callable* self = pointer(from);
+
+        if(op == operation::move)
+        {
+          // moving a heap_callable simply transfers ownership of the node
+          ::new(to) heap_callable*(self);
+        }
+        else
+        {
+          // move the allocator out of the node before destroying it
+          allocator_type alloc = std::move(self->alloc);
+          self->~heap_callable();
+          alloc.deallocate(self, 1);
+        }
       }
     };
 
-    // this deleter calls the destructor of its argument but does not
-    // deallocate the ptr
-    // T will deallocate itself inside ~T()
-    struct self_deallocator_deleter
+    // deallocates a node whose construction did not complete
+    template<class Allocator>
+    struct deallocation_guard
     {
-      template<class T>
+      Allocator& alloc;
+      typename Allocator::value_type* ptr;
+
+      __agency_exec_check_disable__
       __AGENCY_ANNOTATION
-      void operator()(T* ptr) const
+      ~deallocation_guard()
       {
-        ptr->~T();
+        if(ptr)
+        {
+          alloc.deallocate(ptr, 1);
+        }
       }
     };
 
-    using function_pointer = detail::unique_ptr<callable_self_deallocator_base, self_deallocator_deleter>;
-
     template<class Alloc, class Function>
     __AGENCY_ANNOTATION
-    static function_pointer allocate_function_pointer(const Alloc& alloc, Function&& f)
+    void construct(std::true_type /* is_stored_inline */, const Alloc&, Function&& f)
     {
-      using concrete_function_type = callable<typename std::decay<Function>::type, Alloc>;
-      return agency::detail::allocate_unique_with_deleter<concrete_function_type>(alloc, self_deallocator_deleter(), alloc, std::forward<Function>(f));
+      using function_type = typename std::decay<Function>::type;
+
+      ::new(&storage_) function_type(std::forward<Function>(f));
+
+      invoke_ = &inline_callable<function_type>::invoke;
+      manage_ = &inline_callable<function_type>::manage;
     }
 
-    template<class T>
-    struct default_allocator
+    __agency_exec_check_disable__
+    template<class Alloc, class Function>
+    __AGENCY_ANNOTATION
+    void construct(std::false_type /* is_stored_inline */, const Alloc& alloc, Function&& f)
     {
-      using value_type = T;
+      using node_type = heap_callable<typename std::decay<Function>::type, Alloc>;
+      using allocator_type = typename node_type::allocator_type;
 
-      default_allocator() = default;
+      allocator_type node_alloc(alloc);
 
-      default_allocator(const default_allocator&) = default;
+      deallocation_guard<allocator_type> guard{node_alloc, node_alloc.allocate(1)};
+      ::new(guard.ptr) node_type(node_alloc, std::forward<Function>(f));
 
-      template<class U>
-      __AGENCY_ANNOTATION
-      default_allocator(const default_allocator<U>&) {}
+      ::new(&storage_) node_type*(guard.ptr);
+      guard.ptr = nullptr;
 
-      // XXX we have to implement this member function superfluously because
-      //     agency::detail::allocate_unique calls it directly instead of using std::allocator_traits
-      template<class U, class... OtherArgs>
-      __AGENCY_ANNOTATION
-      void construct(U* ptr, OtherArgs&&... args)
-      {
-        ::new(ptr) U(std::forward<OtherArgs>(args)...);
-      }
+      invoke_ = &node_type::invoke;
+      manage_ = &node_type::manage;
+    }
 
-      value_type* allocate(size_t n)
+    __AGENCY_ANNOTATION
+    void move_from(unique_function& other)
+    {
+      if(other)
       {
-        std::allocator<T> alloc;
-        return alloc.allocate(n);
+        other.manage_(operation::move, &other.storage_, &storage_);
+
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+
+        other.invoke_ = nullptr;
+        other.manage_ = nullptr;
       }
+    }
 
-      void deallocate(value_type* ptr, std::size_t n)
+    __AGENCY_ANNOTATION
+    void reset()
+    {
+      if(*this)
       {
-        std::allocator<value_type> alloc;
-        alloc.deallocate(ptr, n);
-      }
-    };
+        manage_(operation::destroy, &storage_, nullptr);
 
+        invoke_ = nullptr;
+        manage_ = nullptr;
+      }
+    }
 
-    function_pointer f_ptr_; 
+    storage_type storage_;
+    invoke_function_type invoke_;
+    manage_function_type manage_;
 };
 
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/execution/blocking_region.hpp>
 #include <agency/execution/executor.hpp>
 #include <agency/execution/execution_agent.hpp>
 #include <agency/execution/execution_policy.hpp>
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/this_worker.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <utility>
+
+
+namespace agency
+{
+namespace this_thread
+{
+
+
+// blocking_region marks a scope in which the current thread may block outside of Agency's control,
+// for example on I/O or on a mutex
+//
+// When the current thread is a worker of a thread pool, the pool may start a spare worker for the duration
+// of the region, so that the pool's other agents continue to occupy its cores:
+//
+//   agency::bulk_invoke(agency::par(n), [&](agency::parallel_agent& self)
+//   {
+//     std::string line;
+//
+//     {
+//       agency::this_thread::blocking_region region;
+//       line = read_record(file, self.index());
+//     }
+//
+//     process(line);
+//   });
+//
+// Outside of a thread pool, and within a region which is already blocking, blocking_region has no effect.
+// Waits on agency::future within a pool's agents need no blocking_region, because such waits execute
+// the pool's queued work rather than block.
+class blocking_region
+{
+  public:
+    blocking_region()
+      : pool_(is_blocking() ? nullptr : agency::detail::this_worker::current_pool())
+    {
+      if(pool_)
+      {
+        is_blocking() = true;
+        pool_->begin_blocking();
+      }
+    }
+
+    ~blocking_region()
+    {
+      if(pool_)
+      {
+        pool_->end_blocking();
+        is_blocking() = false;
+      }
+    }
+
+    blocking_region(const blocking_region&) = delete;
+    blocking_region& operator=(const blocking_region&) = delete;
+
+  private:
+    // whether the current thread is inside a blocking_region which has notified its pool
+    static bool& is_blocking()
+    {
+      static thread_local bool result = false;
+      return result;
+    }
+
+    agency::detail::worker_pool* pool_;
+};
+
+
+// invokes f inside a blocking_region and returns its result
+template<class Function>
+agency::detail::result_of_t<Function()> blocking_invoke(Function&& f)
+{
+  blocking_region region;
+  return std::forward<Function>(f)();
+}
+
+
+} // end this_thread
+} // end agency
+
@@ -5,6 +5,7 @@
 #include <agency/detail/concurrency/any_barrier.hpp>
 #include <agency/memory/detail/resource/arena_resource.hpp>
 #include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <agency/memory/detail/resource/pooled_arena_resource.hpp>
 #include <agency/memory/detail/resource/tiered_resource.hpp>
 #include <agency/coordinate/point.hpp>
 #include <cstddef>
@@ -16,8 +17,18 @@ namespace detail
 {
 
 
+// a concurrent_agent's barrier is an any_barrier in every program, so that concurrent_agent has the same definition
+// in translation units compiled by nvcc and by the host compiler
+// in programs not compiled for CUDA, any_barrier forwards each arrival directly to detail::barrier, so their agents pay no dispatch for it
 using default_barrier = any_barrier;
-using default_concurrent_resource = tiered_resource<arena_resource<sizeof(int) * 128>, malloc_resource>;
+
+// a group's memory resource allocates first from a small arena within the group's shared parameter,
+// then from an arena sized by the execution policy's memory_size(), and finally from malloc
+// the second arena's buffer is pooled, so a group whose temporaries fit its arenas allocates nothing
+using default_concurrent_resource = tiered_resource<
+  tiered_resource<arena_resource<sizeof(int) * 128>, pooled_arena_resource>,
+  malloc_resource
+>;
 
 
 } // end detail
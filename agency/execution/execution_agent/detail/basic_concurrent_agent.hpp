@@ -6,10 +6,14 @@
 #include <agency/execution/execution_agent/detail/basic_execution_agent.hpp>
 #include <agency/detail/concurrency/barrier.hpp>
 #include <agency/detail/concurrency/in_place_barrier.hpp>
+#include <agency/detail/concurrency/arrive_and_wait.hpp>
 #include <agency/container/array.hpp>
 #include <agency/experimental/optional.hpp>
 #include <agency/experimental/variant.hpp>
 #include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
 
 namespace agency
@@ -18,6 +22,28 @@ namespace detail
 {
 
 
+// sized_memory_resource constructs a MemoryResource from a number of bytes when MemoryResource
+// has such a constructor, and otherwise default constructs it
+template<class MemoryResource,
+         bool = std::is_constructible<MemoryResource, std::size_t>::value>
+struct sized_memory_resource : MemoryResource
+{
+  __AGENCY_ANNOTATION
+  sized_memory_resource(std::size_t size)
+    : MemoryResource(size)
+  {}
+};
+
+template<class MemoryResource>
+struct sized_memory_resource<MemoryResource,false> : MemoryResource
+{
+  __AGENCY_ANNOTATION
+  sized_memory_resource(std::size_t)
+    : MemoryResource()
+  {}
+};
+
+
 template<class Index, class Barrier, class MemoryResource>
 class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarantee_t::concurrent_t, Index>
 {
@@ -116,20 +142,25 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
 
       // reinterpret the broadcast channel into a pointer
       static_assert(sizeof(broadcast_channel_type) >= sizeof(T*), "broadcast channel is too small to accomodate T*");
-      T* shared_temporary_object = reinterpret_cast<T*>(&shared_param_.broadcast_channel_);
+      T** shared_temporary_object_ptr = reinterpret_cast<T**>(shared_param_.broadcast_channel_.data());
 
       if(value)
       {
         // dynamically allocate the shared temporary object
-        shared_temporary_object = memory_resource().allocate<alignof(T)>(sizeof(T));
+        T* ptr = reinterpret_cast<T*>(memory_resource().allocate(sizeof(T)));
 
         // copy construct the shared temporary
-        ::new(shared_temporary_object) T(*value);
+        ::new(ptr) T(*value);
+
+        // send its address through the broadcast channel
+        *shared_temporary_object_ptr = ptr;
       }
 
       // all agents wait for the object to be ready
       wait();
 
+      T* shared_temporary_object = *shared_temporary_object_ptr;
+
       // copy the shared temporary to a local variable
       T result = *shared_temporary_object;
 
@@ -142,7 +173,7 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
         shared_temporary_object->~T();
 
         // deallocate the temporary storage
-        memory_resource().deallocate(shared_temporary_object);
+        memory_resource().deallocate(shared_temporary_object, sizeof(T));
       }
 
       // all agents wait for the broadcast channel and memory resource to become ready again
@@ -151,15 +182,223 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
       return result;
     }
 
+    // the slots of the collective operations' scratch space begin on cache line boundaries
+    // so that agents writing to neighboring slots do not contend for a cache line
+    static constexpr std::size_t collective_slot_alignment = 64;
+
+    __AGENCY_ANNOTATION
+    static std::size_t round_up_to_collective_slot_alignment(std::size_t n)
+    {
+      return (n + collective_slot_alignment - 1) / collective_slot_alignment * collective_slot_alignment;
+    }
+
+    // replaces the group's collective scratch space with one whose slots accomodate at least slot_size bytes
+    // the entire group should be convergent before calling this function
+    __AGENCY_ANNOTATION
+    void grow_collective_scratch(std::size_t slot_size)
+    {
+      // every agent must finish with the old slots before they are replaced
+      if(collective_scratch_)
+      {
+        wait();
+      }
+
+      if(this->rank() == 0)
+      {
+        shared_param_.reallocate_collective_scratch(this->group_size(), slot_size);
+      }
+
+      wait();
+
+      collective_scratch_ = shared_param_.collective_scratch_;
+      collective_slot_size_ = shared_param_.collective_slot_size_;
+    }
+
+    // returns the slots which the next phase of the group's collective operation on values of type T should use
+    // the scratch space contains two sets of slots, which consecutive phases alternate between, even across operations
+    // so, before an agent reuses a set of slots, every agent has passed the barrier of the intervening phase,
+    // and so has finished reading the slots
+    // the entire group should be convergent before calling this function
+    template<class T>
+    __AGENCY_ANNOTATION
+    char* next_collective_slots()
+    {
+      static_assert(std::is_trivially_destructible<T>::value, "The values of collective operations must be trivially destructible.");
+      static_assert(alignof(T) <= collective_slot_alignment, "The values of collective operations must not be over-aligned.");
+
+      std::size_t slot_size = round_up_to_collective_slot_alignment(sizeof(T));
+
+      if(slot_size > collective_slot_size_)
+      {
+        grow_collective_scratch(slot_size);
+      }
+
+      char* result = collective_scratch_ + collective_parity_ * this->group_size() * collective_slot_size_;
+      collective_parity_ ^= 1;
+
+      return result;
+    }
+
+    // copies each agent's value into its slot and waits for the group to finish doing so
+    // returns the slots
+    template<class T>
+    __AGENCY_ANNOTATION
+    const char* publish_to_collective_slots(const T& value)
+    {
+      char* slots = next_collective_slots<T>();
+
+      ::new(slots + this->rank() * collective_slot_size_) T(value);
+
+      wait();
+
+      return slots;
+    }
+
+    template<class T>
+    __AGENCY_ANNOTATION
+    const T& collective_slot(const char* slots, std::size_t rank) const
+    {
+      return *reinterpret_cast<const T*>(slots + rank * collective_slot_size_);
+    }
+
+    // each phase of a collective operation combines the partial results of up to collective_radix agents,
+    // so an operation on a group of n agents requires ceil(log_collective_radix(n)) phases
+    static constexpr std::size_t collective_radix = 16;
+
+    // combines the values of the agents of rank [0, rank()) with op
+    // returns an empty optional to the agent of rank 0
+    //
+    // before each phase, every agent's partial result combines the values of the distance agents ending at its own rank
+    // each phase combines an agent's partial result with those of its predecessors at distance, 2 * distance, ...,
+    // which cover the preceding ranks contiguously, so that the next phase's distance is collective_radix times larger
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    experimental::optional<T> combine_values_of_predecessors(const T& value, BinaryOperation op)
+    {
+      T inclusive_partial = value;
+      experimental::optional<T> exclusive_partial;
+
+      for(std::size_t distance = 1; distance < this->group_size(); distance *= collective_radix)
+      {
+        const char* slots = publish_to_collective_slots(inclusive_partial);
+
+        std::size_t num_predecessors = this->rank() / distance < collective_radix - 1 ? this->rank() / distance : collective_radix - 1;
+
+        if(num_predecessors > 0)
+        {
+          T predecessors = collective_slot<T>(slots, this->rank() - num_predecessors * distance);
+
+          for(std::size_t i = num_predecessors - 1; i > 0; --i)
+          {
+            predecessors = op(predecessors, collective_slot<T>(slots, this->rank() - i * distance));
+          }
+
+          inclusive_partial = op(predecessors, inclusive_partial);
+          exclusive_partial = exclusive_partial ? op(predecessors, *exclusive_partial) : predecessors;
+        }
+      }
+
+      return exclusive_partial;
+    }
+
+    // combines the values of every agent of the group with op
+    // the phases proceed as in combine_values_of_predecessors(), except that during the final phase,
+    // every agent combines the partial results which end at the group's last agent
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T combine_values_of_group(const T& value, BinaryOperation op)
+    {
+      T partial = value;
+
+      for(std::size_t distance = 1; distance < this->group_size(); distance *= collective_radix)
+      {
+        const char* slots = publish_to_collective_slots(partial);
+
+        bool final_phase = distance * collective_radix >= this->group_size();
+        std::size_t last_rank = final_phase ? this->group_size() - 1 : this->rank();
+
+        partial = collective_slot<T>(slots, last_rank);
+
+        for(std::size_t i = 1; i < collective_radix && i * distance <= last_rank; ++i)
+        {
+          partial = op(collective_slot<T>(slots, last_rank - i * distance), partial);
+        }
+      }
+
+      return partial;
+    }
+
+    struct logical_or_operation
+    {
+      __AGENCY_ANNOTATION
+      bool operator()(bool x, bool y) const
+      {
+        return x || y;
+      }
+    };
+
+    struct logical_and_operation
+    {
+      __AGENCY_ANNOTATION
+      bool operator()(bool x, bool y) const
+      {
+        return x && y;
+      }
+    };
+
   public:
-    using param_type = typename super_t::param_type;
+    // a concurrent agent's parameterization additionally includes the number of bytes
+    // of memory which its group's memory resource reserves when the group is created
+    class param_type : public super_t::param_type
+    {
+      private:
+        using super_param_type = typename super_t::param_type;
+        using domain_type = typename super_t::domain_type;
+        using index_type = typename super_t::index_type;
+
+      public:
+        // initialize memory_size_ explicitly, because a default-initialized param_type would otherwise reserve
+        // an indeterminate number of bytes
+        __AGENCY_ANNOTATION
+        constexpr param_type()
+          : super_param_type(),
+            memory_size_(0)
+        {}
+
+        param_type(const param_type& other) = default;
+
+        __AGENCY_ANNOTATION
+        param_type(const super_param_type& other, std::size_t memory_size = 0)
+          : super_param_type(other),
+            memory_size_(memory_size)
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const domain_type& d)
+          : param_type(super_param_type(d))
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const index_type& min, const index_type& max)
+          : param_type(super_param_type(min, max))
+        {}
+
+        __AGENCY_ANNOTATION
+        std::size_t memory_size() const
+        {
+          return memory_size_;
+        }
+
+      private:
+        std::size_t memory_size_;
+    };
 
     using index_type = typename super_t::index_type;
 
     __AGENCY_ANNOTATION
     void wait() const
     {
-      shared_param_.barrier_.arrive_and_wait();
+      detail::arrive_and_wait(shared_param_.barrier_, this->rank());
     }
 
     template<class T>
@@ -169,6 +408,69 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
       return broadcast_impl(value);
     }
 
+    // The collective operations below must be called by every agent of the group, in the same order.
+    // Each operates on a value of trivially destructible type, and requires one barrier per phase,
+    // ceil(log16(group_size())) in all (the first operation on a type larger than any before it requires up to two more).
+    // The operations combine values in rank order, so op must be associative, but need not be commutative.
+
+    // reduce() combines every agent's value with op and returns the result to the agent of rank 0
+    // the other agents receive an empty optional
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    experimental::optional<T> reduce(const T& value, BinaryOperation op)
+    {
+      T result = combine_values_of_group(value, op);
+
+      if(this->rank() == 0)
+      {
+        return result;
+      }
+
+      return experimental::nullopt;
+    }
+
+    // all_reduce() combines every agent's value with op and returns the result to every agent
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T all_reduce(const T& value, BinaryOperation op)
+    {
+      return combine_values_of_group(value, op);
+    }
+
+    // inclusive_scan() returns the combination of the values of the agents of rank [0, rank()]
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T inclusive_scan(const T& value, BinaryOperation op)
+    {
+      experimental::optional<T> predecessors = combine_values_of_predecessors(value, op);
+
+      return predecessors ? op(*predecessors, value) : value;
+    }
+
+    // exclusive_scan() returns the combination of init and the values of the agents of rank [0, rank())
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T exclusive_scan(const T& value, const T& init, BinaryOperation op)
+    {
+      experimental::optional<T> predecessors = combine_values_of_predecessors(value, op);
+
+      return predecessors ? op(init, *predecessors) : init;
+    }
+
+    // any() returns whether the vote of any agent is true
+    __AGENCY_ANNOTATION
+    bool any(bool vote)
+    {
+      return all_reduce(vote, logical_or_operation());
+    }
+
+    // all() returns whether the vote of every agent is true
+    __AGENCY_ANNOTATION
+    bool all(bool vote)
+    {
+      return all_reduce(vote, logical_and_operation());
+    }
+
     using memory_resource_type = MemoryResource;
 
     __AGENCY_ANNOTATION
@@ -183,7 +485,12 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
         __AGENCY_ANNOTATION
         shared_param_type(const param_type& param)
           : barrier_(param.domain().size()),
-            memory_resource_()
+            memory_resource_(param.memory_size()),
+            memory_size_(param.memory_size()),
+            collective_scratch_(nullptr),
+            collective_slot_size_(0),
+            collective_allocation_(nullptr),
+            collective_allocation_size_(0)
         {
           // note we specifically avoid default constructing broadcast_channel_
         }
@@ -195,7 +502,12 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
         __AGENCY_ANNOTATION
         shared_param_type(const param_type& param, experimental::in_place_type_t<OtherBarrier> which_barrier)
           : barrier_(which_barrier, param.domain().size()),
-            memory_resource_()
+            memory_resource_(param.memory_size()),
+            memory_size_(param.memory_size()),
+            collective_scratch_(nullptr),
+            collective_slot_size_(0),
+            collective_allocation_(nullptr),
+            collective_allocation_size_(0)
         {
           // note we specifically avoid default constructing broadcast_channel_
         }
@@ -209,15 +521,56 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
         __AGENCY_ANNOTATION
         shared_param_type(shared_param_type&& other)
           : barrier_(other.barrier_.index(), other.barrier_.count()),
-            memory_resource_()
+            memory_resource_(other.memory_size_),
+            memory_size_(other.memory_size_),
+            collective_scratch_(nullptr),
+            collective_slot_size_(0),
+            collective_allocation_(nullptr),
+            collective_allocation_size_(0)
         {}
 
+        __AGENCY_ANNOTATION
+        ~shared_param_type()
+        {
+          if(collective_allocation_)
+          {
+            memory_resource_.deallocate(collective_allocation_, collective_allocation_size_);
+          }
+        }
+
       private:
         // broadcast_channel_ needs to be the first member to ensure proper alignment because we reinterpret it to arbitrary T*
         // XXX is there a more comprehensive way to ensure that this member falls on the right address?
         broadcast_channel_type broadcast_channel_;
         barrier_type barrier_;
-        memory_resource_type memory_resource_;
+
+        // the group's memory resource reserves memory_size_ bytes when it is able
+        sized_memory_resource<memory_resource_type> memory_resource_;
+        std::size_t memory_size_;
+
+        // the scratch space of the group's collective operations contains two sets of slots, one slot per agent in each set
+        // the scratch space is allocated by the group's first collective operation, and is retained until the group ends
+        char* collective_scratch_;
+        std::size_t collective_slot_size_;
+        void* collective_allocation_;
+        std::size_t collective_allocation_size_;
+
+        __AGENCY_ANNOTATION
+        void reallocate_collective_scratch(std::size_t group_size, std::size_t slot_size)
+        {
+          if(collective_allocation_)
+          {
+            memory_resource_.deallocate(collective_allocation_, collective_allocation_size_);
+          }
+
+          // allocate enough extra space to align the first slot
+          collective_allocation_size_ = 2 * group_size * slot_size + collective_slot_alignment - 1;
+          collective_allocation_ = memory_resource_.allocate(collective_allocation_size_);
+
+          std::uintptr_t address = reinterpret_cast<std::uintptr_t>(collective_allocation_);
+          collective_scratch_ = reinterpret_cast<char*>(round_up_to_collective_slot_alignment(address));
+          collective_slot_size_ = slot_size;
+        }
 
         friend basic_concurrent_agent;
     };
@@ -225,11 +578,19 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
   private:
     shared_param_type& shared_param_;
 
+    // this agent's copy of the group's collective scratch space, and which of its sets of slots to use next
+    char* collective_scratch_;
+    std::size_t collective_slot_size_;
+    std::size_t collective_parity_;
+
   protected:
     __AGENCY_ANNOTATION
     basic_concurrent_agent(const index_type& index, const param_type& param, shared_param_type& shared_param)
       : super_t(index, param),
-        shared_param_(shared_param)
+        shared_param_(shared_param),
+        collective_scratch_(nullptr),
+        collective_slot_size_(0),
+        collective_parity_(0)
     {}
 
     // friend execution_agent_traits to give it access to the constructor
@@ -13,6 +13,7 @@
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/scoped_executor.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/require.hpp>
 
 #include <utility>
 #include <tuple>
@@ -258,6 +259,35 @@ class basic_execution_policy
       return this->on(agency::associated_executor(std::forward<T>(has_associated_executor)));
     }
 
+    /// \brief Requires a property of this execution policy's executor.
+    ///
+    ///
+    /// require() returns a new execution policy identical to `*this` but whose associated
+    /// executor has been adapted to satisfy a property.
+    ///
+    /// For example, we can require the agents of a parallel task whose agents have skewed costs
+    /// to be balanced among the executor's threads at runtime:
+    ///
+    /// ~~~~{.cpp}
+    /// agency::bulk_invoke(agency::par(n).require(agency::schedule.guided), [](agency::parallel_agent& self)
+    /// {
+    ///   do_work_of_varying_cost(self.index());
+    /// });
+    /// ~~~~
+    ///
+    /// \param prop The property to require of this execution policy's executor.
+    /// \return An execution policy equivalent to `*this` but whose associated executor is `agency::require(executor(), prop)`.
+    /// \note require() is sugar for the expression `this->on(agency::require(executor(), prop))`.
+    /// \see on
+    __agency_exec_check_disable__
+    template<class Property>
+    __AGENCY_ANNOTATION
+    auto require(const Property& prop) const ->
+      decltype(this->on(agency::require(this->executor(), prop)))
+    {
+      return this->on(agency::require(executor(), prop));
+    }
+
     /// \brief Reparameterizes this execution policy.
     ///
     ///
@@ -8,6 +8,7 @@
 #include <agency/execution/executor/concurrent_executor.hpp>
 #include <agency/execution/execution_agent.hpp>
 #include <agency/execution/execution_policy/basic_execution_policy.hpp>
+#include <cstddef>
 
 namespace agency
 {
@@ -35,6 +36,33 @@ class concurrent_execution_policy : public basic_execution_policy<concurrent_age
 
   public:
     using super_t::basic_execution_policy;
+
+    /// \brief Reserves memory for each group of agents created by this execution policy.
+    ///
+    ///
+    /// memory_size() returns a new execution policy identical to `*this` but whose groups of agents each reserve
+    /// `num_bytes` bytes of memory when they are created, similar to CUDA's dynamic shared memory.
+    /// The group's temporary shared objects, such as those created by `shared_vector`, are allocated from the reserved
+    /// memory when they do not fit in the group's small built-in arena.
+    /// The reserved memory is pooled and reused by later groups, so a group whose temporary shared objects fit
+    /// allocates no memory at all.
+    ///
+    /// ~~~~{.cpp}
+    /// agency::bulk_invoke(agency::con(n).memory_size(n * sizeof(float)), [](agency::concurrent_agent& self)
+    /// {
+    ///   agency::shared_vector<float> scratch(self, self.group_size(), 0.f);
+    ///   ...
+    /// });
+    /// ~~~~
+    ///
+    /// \param num_bytes The number of bytes of memory to reserve for each group.
+    /// \return An execution policy equivalent to `*this` but whose parameterization's `memory_size()` is `num_bytes`.
+    /// \note Because `operator()` constructs a new parameterization, memory_size() should be called after the group's shape is given.
+    __AGENCY_ANNOTATION
+    concurrent_execution_policy memory_size(std::size_t num_bytes) const
+    {
+      return concurrent_execution_policy(param_type(this->param(), num_bytes), this->executor());
+    }
 };
 
 
@@ -65,6 +93,33 @@ class concurrent_execution_policy_2d : public basic_execution_policy<concurrent_
 
   public:
     using super_t::basic_execution_policy;
+
+    /// \brief Reserves memory for each group of agents created by this execution policy.
+    ///
+    ///
+    /// memory_size() returns a new execution policy identical to `*this` but whose groups of agents each reserve
+    /// `num_bytes` bytes of memory when they are created, similar to CUDA's dynamic shared memory.
+    /// The group's temporary shared objects, such as those created by `shared_vector`, are allocated from the reserved
+    /// memory when they do not fit in the group's small built-in arena.
+    /// The reserved memory is pooled and reused by later groups, so a group whose temporary shared objects fit
+    /// allocates no memory at all.
+    ///
+    /// ~~~~{.cpp}
+    /// agency::bulk_invoke(agency::con(n).memory_size(n * sizeof(float)), [](agency::concurrent_agent& self)
+    /// {
+    ///   agency::shared_vector<float> scratch(self, self.group_size(), 0.f);
+    ///   ...
+    /// });
+    /// ~~~~
+    ///
+    /// \param num_bytes The number of bytes of memory to reserve for each group.
+    /// \return An execution policy equivalent to `*this` but whose parameterization's `memory_size()` is `num_bytes`.
+    /// \note Because `operator()` constructs a new parameterization, memory_size() should be called after the group's shape is given.
+    __AGENCY_ANNOTATION
+    concurrent_execution_policy_2d memory_size(std::size_t num_bytes) const
+    {
+      return concurrent_execution_policy_2d(param_type(this->param(), num_bytes), this->executor());
+    }
 };
 
 
@@ -1,16 +1,14 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/future.hpp>
+#include <agency/future/future.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
-#include <agency/detail/invoke.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/execution/executor/detail/concurrent_group.hpp>
 #include <agency/detail/type_traits.hpp>
+#include <agency/detail/concurrency/concurrent_thread_pool.hpp>
 
 #include <thread>
-#include <vector>
-#include <memory>
-#include <algorithm>
-#include <utility>
 
 
 namespace agency
@@ -35,13 +33,28 @@ class concurrent_executor
       return bulk_guarantee_t::concurrent_t();
     }
 
+    // each agent receives a thread of its own, so no agent waits behind other work, and priority has no effect
+    // these requirements are accepted so that code which requires a priority works with each of Agency's host executors
+    concurrent_executor require(const priority_t::high_t&) const
+    {
+      return *this;
+    }
+
+    concurrent_executor require(const priority_t::normal_t&) const
+    {
+      return *this;
+    }
+
+    template<class T>
+    using future = agency::future<T>;
+
     template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<
+    future<
       detail::result_of_t<ResultFactory()>
     >
     bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
     {
-      return bulk_then_execute_impl(f, n, predecessor, result_factory, shared_factory);
+      return detail::bulk_then_execute_concurrent_group(f, n, predecessor, result_factory, shared_factory, submit_to_concurrent_thread_pool());
     }
 
     __AGENCY_ANNOTATION
@@ -57,132 +70,15 @@ class concurrent_executor
     }
 
   private:
-    template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<agency::detail::result_of_t<ResultFactory()>>
-      bulk_then_execute_impl(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory,
-                             typename std::enable_if<
-                               !std::is_void<
-                                 future_result_t<Future>
-                               >::value
-                             >::type* = 0) const
+    struct submit_to_concurrent_thread_pool
     {
-      if(n > 0)
+      template<class Function>
+      void operator()(Function agent, size_t n) const
       {
-        using predecessor_type = future_result_t<Future>;
-
-        return agency::detail::monadic_then(predecessor, std::launch::async, [=](predecessor_type& predecessor) mutable
-        {
-          // put all the shared parameters on the first thread's stack
-          auto result = result_factory();
-          auto shared_parameter = shared_factory();
-
-          // create a lambda to handle parameter passing
-          auto g = [&,f](size_t idx)
-          {
-            agency::detail::invoke(f, idx, predecessor, result, shared_parameter);
-          };
-
-          size_t mid = n / 2;
-
-          std::future<void> left = agency::detail::make_ready_future();
-          if(0 < mid)
-          {
-            left = this->twoway_execute(g, 0, mid);
-          }
-
-          std::future<void> right = agency::detail::make_ready_future();
-          if(mid + 1 < n)
-          {
-            right = this->twoway_execute(g, mid + 1, n);
-          }
-
-          g(mid);
-
-          left.wait();
-          right.wait();
-
-          return std::move(result);
-        });
+        // each agent receives a thread of its own
+        detail::system_concurrent_thread_pool().bulk_submit(agent, n);
       }
-
-      return agency::detail::make_ready_future(result_factory());
-    }
-
-    template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<agency::detail::result_of_t<ResultFactory()>>
-      bulk_then_execute_impl(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory,
-                             typename std::enable_if<
-                               std::is_void<
-                                 future_result_t<Future>
-                               >::value
-                             >::type* = 0) const
-    {
-      if(n > 0)
-      {
-        return agency::detail::monadic_then(predecessor, std::launch::async, [=]() mutable
-        {
-          // put all the shared parameters on the first thread's stack
-          auto result = result_factory();
-          auto shared_parameter = shared_factory();
-
-          // create a lambda to handle parameter passing
-          auto g = [&,f](size_t idx)
-          {
-            agency::detail::invoke(f, idx, result, shared_parameter);
-          };
-
-          size_t mid = n / 2;
-
-          std::future<void> left = agency::detail::make_ready_future();
-          if(0 < mid)
-          {
-            left = this->twoway_execute(g, 0, mid);
-          }
-
-          std::future<void> right = agency::detail::make_ready_future();
-          if(mid + 1 < n)
-          {
-            right = this->twoway_execute(g, mid + 1, n);
-          }
-
-          g(mid);
-
-          left.wait();
-          right.wait();
-
-          return std::move(result);
-        });
-      }
-
-      return agency::detail::make_ready_future(result_factory());
-    }
-
-    // first must be less than last
-    template<class Function>
-    std::future<void> twoway_execute(Function f, size_t first, size_t last) const
-    {
-      return std::async(std::launch::async, [=]() mutable
-      {
-        size_t mid = (last + first) / 2;
-
-        std::future<void> left = detail::make_ready_future();
-        if(first < mid)
-        {
-          left = this->twoway_execute(f, first, mid);
-        }
-
-        std::future<void> right = detail::make_ready_future();
-        if(mid + 1 < last)
-        {
-          right = this->twoway_execute(f, mid + 1, last);
-        }
-
-        agency::detail::invoke(f,mid);
-
-        left.wait();
-        right.wait();
-      });
-    }
+    };
 };
 
 
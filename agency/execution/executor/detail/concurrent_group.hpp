@@ -0,0 +1,170 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/invoke.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/future.hpp>
+#include <agency/future/future.hpp>
+#include <agency/future/promise.hpp>
+#include <agency/future/detail/invoke_when_ready.hpp>
+
+#include <mutex>
+#include <exception>
+#include <memory>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// the state shared by the agents of a single concurrent group
+// the promise is fulfilled when the final agent releases its reference to the state
+template<class SharedFuture, class Result, class SharedParameter>
+struct concurrent_group_state
+{
+  SharedFuture predecessor;
+  Result result;
+  SharedParameter shared_parameter;
+  agency::promise<Result> promise;
+
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  template<class ResultFactory, class SharedFactory>
+  concurrent_group_state(const SharedFuture& predecessor, ResultFactory result_factory, SharedFactory shared_factory)
+    : predecessor(predecessor),
+      result(result_factory()),
+      shared_parameter(shared_factory())
+  {}
+
+  ~concurrent_group_state()
+  {
+    if(exception)
+    {
+      promise.set_exception(exception);
+    }
+    else
+    {
+      promise.set_value(std::move(result));
+    }
+  }
+
+  // the group's first exception becomes its result
+  void set_exception(std::exception_ptr e)
+  {
+    std::lock_guard<std::mutex> lock(exception_mutex);
+
+    if(!exception)
+    {
+      exception = e;
+    }
+  }
+
+  template<class Function>
+  void invoke_agent(Function& f, size_t idx)
+  {
+    invoke_agent_impl(std::is_void<future_result_t<SharedFuture>>(), f, idx);
+  }
+
+  private:
+    template<class Function>
+    void invoke_agent_impl(std::false_type, Function& f, size_t idx)
+    {
+      using predecessor_type = future_result_t<SharedFuture>;
+      predecessor_type& predecessor_arg = const_cast<predecessor_type&>(predecessor.get());
+
+      agency::detail::invoke(f, idx, predecessor_arg, result, shared_parameter);
+    }
+
+    template<class Function>
+    void invoke_agent_impl(std::true_type, Function& f, size_t idx)
+    {
+      agency::detail::invoke(f, idx, result, shared_parameter);
+    }
+};
+
+
+// adapts the submit function of bulk_then_execute_concurrent_group() to submit a single task as a group of one agent
+template<class Submit>
+struct submit_single_agent
+{
+  Submit submit;
+
+  template<class Function>
+  void operator()(Function task) const
+  {
+    submit([=](size_t) mutable
+    {
+      task();
+    },
+    1);
+  }
+};
+
+
+// bulk_then_execute_concurrent_group() implements bulk_then_execute() for executors which create concurrent agents
+//
+// once predecessor is ready, bulk_then_execute_concurrent_group() calls submit(agent, n), which must
+// arrange for agent(i) to be invoked for each i in [0, n) such that all invocations progress concurrently
+template<class Function, class Future, class ResultFactory, class SharedFactory, class Submit>
+agency::future<result_of_t<ResultFactory()>>
+  bulk_then_execute_concurrent_group(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory, Submit submit)
+{
+  using result_type = result_of_t<ResultFactory()>;
+
+  if(n > 0)
+  {
+    auto shared_predecessor = future_traits<Future>::share(predecessor);
+
+    using shared_future_type = decltype(shared_predecessor);
+    using shared_parameter_type = result_of_t<SharedFactory()>;
+    using group_state_type = concurrent_group_state<shared_future_type, result_type, shared_parameter_type>;
+
+    auto state = std::make_shared<group_state_type>(shared_predecessor, result_factory, shared_factory);
+
+    agency::future<result_type> result_future = state->promise.get_future();
+
+    // create the function each agent invokes
+    auto agent = [=](size_t idx) mutable
+    {
+      try
+      {
+        state->invoke_agent(f, idx);
+      }
+      catch(...)
+      {
+        state->set_exception(std::current_exception());
+      }
+    };
+
+    // launch the group once the predecessor is ready, rather than dedicating a thread to waiting on it
+    detail::invoke_when_ready(shared_predecessor, [=]() mutable
+    {
+      try
+      {
+        state->predecessor.get();
+      }
+      catch(...)
+      {
+        // an exceptional predecessor creates no agents and its exception becomes the result
+        state->set_exception(std::current_exception());
+        return;
+      }
+
+      submit(agent, n);
+    },
+    submit_single_agent<Submit>{submit});
+
+    return result_future;
+  }
+
+  return agency::future<result_type>::make_ready(result_factory());
+}
+
+
+} // end detail
+} // end agency
+
@@ -6,6 +6,7 @@
 #include <agency/execution/executor/executor_traits/executor_shape.hpp>
 #include <agency/execution/executor/executor_traits/executor_execution_depth.hpp>
 #include <agency/execution/executor/executor_traits/is_executor.hpp>
+#include <agency/execution/executor/executor_traits/detail/has_bulk_sync_execute_member.hpp>
 #include <agency/execution/executor/detail/adaptors/executor_ref.hpp>
 #include <agency/execution/executor/properties/always_blocking.hpp>
 #include <agency/execution/executor/properties/bulk.hpp>
@@ -19,10 +20,26 @@ namespace detail
 {
 
 
+// this overload handles executors which execute bulk work synchronously through .bulk_sync_execute()
 __agency_exec_check_disable__
 template<class E, class Function, class ResultFactory, class... Factories,
          __AGENCY_REQUIRES(is_executor<E>::value),
-         __AGENCY_REQUIRES(executor_execution_depth<E>::value == sizeof...(Factories))
+         __AGENCY_REQUIRES(executor_execution_depth<E>::value == sizeof...(Factories)),
+         __AGENCY_REQUIRES(has_bulk_sync_execute_member<E, Function, executor_shape_t<E>, ResultFactory, Factories...>::value)
+        >
+__AGENCY_ANNOTATION
+detail::result_of_t<ResultFactory()>
+blocking_bulk_twoway_execute(const E& exec, Function f, executor_shape_t<E> shape, ResultFactory result_factory, Factories... shared_factories)
+{
+  return exec.bulk_sync_execute(f, shape, result_factory, shared_factories...);
+}
+
+
+__agency_exec_check_disable__
+template<class E, class Function, class ResultFactory, class... Factories,
+         __AGENCY_REQUIRES(is_executor<E>::value),
+         __AGENCY_REQUIRES(executor_execution_depth<E>::value == sizeof...(Factories)),
+         __AGENCY_REQUIRES(!has_bulk_sync_execute_member<E, Function, executor_shape_t<E>, ResultFactory, Factories...>::value)
         >
 __AGENCY_ANNOTATION
 detail::result_of_t<ResultFactory()>
@@ -11,6 +11,7 @@
 #include <agency/execution/executor/detail/utility.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/executor_traits/detail/member_barrier_type_or.hpp>
+#include <agency/execution/executor/executor_traits/detail/has_bulk_sync_execute_member.hpp>
 #include <agency/execution/executor/customization_points.hpp>
 #include <agency/execution/executor/detail/execution_functions/bulk_then_execute.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
@@ -70,6 +71,13 @@ class executor_array
       : inner_executors_(n, exec)
     {}
 
+    __agency_exec_check_disable__
+    __AGENCY_ANNOTATION
+    executor_array(const outer_executor_type& outer_exec, size_t n, const inner_executor_type& exec = inner_executor_type())
+      : outer_executor_(outer_exec),
+        inner_executors_(n, exec)
+    {}
+
     template<class Iterator>
     executor_array(Iterator executors_begin, Iterator executors_end)
       : inner_executors_(executors_begin, executors_end)
@@ -434,6 +442,31 @@ class executor_array
       return bulk_then_execute_impl(bulk_then_execute_implementation_strategy(), f, shape, predecessor, result_factory, outer_factory, inner_factories...);
     }
 
+    // this overload of bulk_sync_execute() exists when the outer executor executes its bulk work synchronously
+    // each outer agent executes its group of inner agents synchronously, as in the lazy implementation of bulk_then_execute()
+    template<class Function, class ResultFactory, class OuterFactory, class... InnerFactories,
+             __AGENCY_REQUIRES(sizeof...(InnerFactories) == inner_depth),
+             __AGENCY_REQUIRES(
+               detail::has_bulk_sync_execute_member<
+                 outer_executor_type,
+                 lazy_bulk_then_execute_functor<Function,InnerFactories...>,
+                 outer_shape_type,
+                 ResultFactory,
+                 OuterFactory
+               >::value
+             )>
+    __AGENCY_ANNOTATION
+    detail::result_of_t<ResultFactory()>
+      bulk_sync_execute(Function f, shape_type shape, ResultFactory result_factory, OuterFactory outer_factory, InnerFactories... inner_factories) const
+    {
+      outer_shape_type outer_shape = this->outer_shape(shape);
+      inner_shape_type inner_shape = this->inner_shape(shape);
+
+      lazy_bulk_then_execute_functor<Function,InnerFactories...> execute_me{*this,outer_shape,inner_shape,f,agency::make_tuple(inner_factories...)};
+
+      return outer_executor().bulk_sync_execute(execute_me, outer_shape, result_factory, outer_factory);
+    }
+
   private:
     outer_executor_type            outer_executor_;
 
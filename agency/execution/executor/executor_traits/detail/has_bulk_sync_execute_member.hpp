@@ -0,0 +1,58 @@
+// Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <utility>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// bulk_sync_execute() is an optional execution function of bulk executors
+// it creates agents like bulk_twoway_execute(), but returns their result directly once they are complete
+// rather than through a future, so that executors may enlist the calling thread to execute agents
+template<class T, class Function, class Shape, class ResultFactory, class... SharedFactories>
+using bulk_sync_execute_member_t = decltype(std::declval<const T&>().bulk_sync_execute(std::declval<Function>(), std::declval<Shape>(), std::declval<ResultFactory>(), std::declval<SharedFactories>()...));
+
+
+template<class Executor, class Function, class Shape,
+         class ResultFactory,
+         class... SharedFactories
+        >
+using has_bulk_sync_execute_member = is_detected_exact<
+  result_of_t<ResultFactory()>,
+  bulk_sync_execute_member_t, Executor, Function, Shape, ResultFactory, SharedFactories...
+>;
+
+
+} // end detail
+} // end agency
+
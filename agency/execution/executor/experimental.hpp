@@ -1,5 +1,6 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/execution/executor/experimental/fiber_executor.hpp>
 #include <agency/execution/executor/experimental/unrolling_executor.hpp>
 
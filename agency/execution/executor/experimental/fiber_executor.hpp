@@ -0,0 +1,125 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/future/future.hpp>
+#include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/detail/concurrent_group.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/concurrency/concurrent_thread_pool.hpp>
+#include <agency/detail/concurrency/fiber.hpp>
+
+#include <algorithm>
+#include <thread>
+
+
+namespace agency
+{
+namespace experimental
+{
+
+
+// fiber_executor creates concurrent execution agents as fibers
+//
+// The agents of a group are divided among a few threads, and each thread multiplexes its
+// agents as fibers with small, pooled stacks. When an agent waits on its group's barrier,
+// it switches to another fiber rather than blocking its thread. So, groups of thousands of
+// concurrent agents are inexpensive.
+//
+// Fibers switch only when they wait on a barrier or finish. An agent which waits on another agent of
+// its group through any other means (e.g., a mutex or a spin loop) may prevent that agent from progressing.
+class fiber_executor
+{
+  public:
+    // num_threads is the maximum number of threads which execute a single group of agents
+    // stack_size is the size in bytes of each agent's stack
+    explicit fiber_executor(size_t num_threads = std::max(1u, std::thread::hardware_concurrency()),
+                            size_t stack_size = agency::detail::default_fiber_stack_size)
+      : num_threads_(std::max<size_t>(1, num_threads)),
+        stack_size_(stack_size)
+    {}
+
+    __AGENCY_ANNOTATION
+    constexpr static bulk_guarantee_t::concurrent_t query(const bulk_guarantee_t&)
+    {
+      return bulk_guarantee_t::concurrent_t();
+    }
+
+    size_t unit_shape() const
+    {
+      return num_threads_;
+    }
+
+    size_t num_threads() const
+    {
+      return num_threads_;
+    }
+
+    size_t stack_size() const
+    {
+      return stack_size_;
+    }
+
+    template<class T>
+    using future = agency::future<T>;
+
+    template<class Function, class Future, class ResultFactory, class SharedFactory>
+    future<
+      agency::detail::result_of_t<ResultFactory()>
+    >
+    bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
+    {
+      return agency::detail::bulk_then_execute_concurrent_group(f, n, predecessor, result_factory, shared_factory, submit_as_fibers{num_threads_, stack_size_});
+    }
+
+    friend bool operator==(const fiber_executor& a, const fiber_executor& b) noexcept
+    {
+      return a.num_threads_ == b.num_threads_ && a.stack_size_ == b.stack_size_;
+    }
+
+    friend bool operator!=(const fiber_executor& a, const fiber_executor& b) noexcept
+    {
+      return !(a == b);
+    }
+
+  private:
+    struct submit_as_fibers
+    {
+      size_t num_threads;
+      size_t stack_size;
+
+      template<class Function>
+      void operator()(Function agent, size_t n) const
+      {
+        size_t num_threads = std::min(this->num_threads, n);
+        size_t stack_size = this->stack_size;
+
+        // each thread schedules a contiguous subset of the agents
+        agency::detail::system_concurrent_thread_pool().bulk_submit([=](size_t thread_idx)
+        {
+          size_t first = thread_idx * n / num_threads;
+          size_t last = (thread_idx + 1) * n / num_threads;
+
+          agency::detail::fiber_scheduler scheduler(stack_size);
+
+          for(size_t idx = first; idx < last; ++idx)
+          {
+            scheduler.spawn([=]() mutable
+            {
+              agent(idx);
+            });
+          }
+
+          scheduler.run();
+        },
+        num_threads);
+      }
+    };
+
+    size_t num_threads_;
+    size_t stack_size_;
+};
+
+
+} // end experimental
+} // end agency
+
@@ -13,7 +13,10 @@
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/scoped_executor.hpp>
 #include <agency/execution/executor/customization_points.hpp>
+#include <agency/execution/executor/executor_traits/detail/has_bulk_sync_execute_member.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/execution/executor/executor_traits/detail/has_require_member.hpp>
 #include <agency/execution/executor/query.hpp>
 #include <agency/detail/algorithm/min.hpp>
 #include <agency/detail/algorithm/max.hpp>
@@ -291,6 +294,26 @@ class flattened_executor
       return detail::flatten_bulk_guarantee(agency::query(base_executor(), prop));
     }
 
+    template<class Priority,
+             __AGENCY_REQUIRES(
+               detail::is_priority_property<Priority>::value &&
+               detail::has_require_member<base_executor_type, Priority>::value
+             )>
+    flattened_executor require(const Priority& prop) const
+    {
+      return flattened_executor(base_executor().require(prop));
+    }
+
+    template<class Priority,
+             __AGENCY_REQUIRES(
+               detail::is_priority_property<Priority>::value &&
+               detail::has_require_member<base_executor_type, Priority>::value
+             )>
+    bool query(const Priority& prop) const
+    {
+      return base_executor().query(prop);
+    }
+
     template<class Function, class Future, class ResultFactory, class OuterFactory, class... InnerFactories,
              __AGENCY_REQUIRES(sizeof...(InnerFactories) == execution_depth - 1)
             >
@@ -307,6 +330,32 @@ class flattened_executor
       return detail::bulk_then_execute(base_executor(), execute_me, base_shape, predecessor, result_factory, outer_factory, agency::detail::unit_factory(), inner_factories...);
     }
 
+    // this overload of bulk_sync_execute() exists when the base executor executes its bulk work synchronously
+    template<class Function, class ResultFactory, class OuterFactory, class... InnerFactories,
+             __AGENCY_REQUIRES(sizeof...(InnerFactories) == execution_depth - 1),
+             __AGENCY_REQUIRES(
+               detail::has_bulk_sync_execute_member<
+                 base_executor_type,
+                 detail::flatten_index_and_invoke<executor_index_t<base_executor_type>, void, Function, executor_shape_t<base_executor_type>>,
+                 executor_shape_t<base_executor_type>,
+                 ResultFactory,
+                 OuterFactory,
+                 agency::detail::unit_factory,
+                 InnerFactories...
+               >::value
+             )>
+    __AGENCY_ANNOTATION
+    detail::result_of_t<ResultFactory()>
+      bulk_sync_execute(Function f, shape_type shape, ResultFactory result_factory, OuterFactory outer_factory, InnerFactories... inner_factories) const
+    {
+      base_shape_type base_shape = partition_into_base_shape(shape);
+
+      using base_index_type = executor_index_t<base_executor_type>;
+      auto execute_me = detail::make_flatten_index_and_invoke<base_index_type,void>(f, base_shape, shape);
+
+      return base_executor().bulk_sync_execute(execute_me, base_shape, result_factory, outer_factory, agency::detail::unit_factory(), inner_factories...);
+    }
+
     __AGENCY_ANNOTATION
     shape_type unit_shape() const
     {
@@ -0,0 +1,118 @@
+// Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <type_traits>
+
+
+namespace agency
+{
+
+
+// priority_t describes the order in which an executor executes work which is waiting to execute
+//
+// Its nested properties select a priority:
+//   * normal_t work executes in the order it was submitted
+//   * high_t work executes before any waiting normal_t work
+//
+// High priority is meant for latency-sensitive work, such as an interactive task submitted while a
+// long batch job is executing. An executor which supports priorities provides member functions
+// require() and query() for these properties. Long-running normal_t work on such an executor yields
+// to waiting high_t work periodically, so high_t work need not wait for the whole batch to drain.
+//
+// parallel_executor and the executors composed of a thread pool executor forward priority to that executor.
+// concurrent_executor accepts priority requirements but ignores them, because its agents never wait behind other work.
+struct priority_t
+{
+  static constexpr bool is_requirable = false;
+  static constexpr bool is_preferable = false;
+
+  struct normal_t
+  {
+    static constexpr bool is_requirable = true;
+    static constexpr bool is_preferable = true;
+
+    __AGENCY_ANNOTATION
+    constexpr normal_t value() const
+    {
+      return *this;
+    }
+  };
+
+  struct high_t
+  {
+    static constexpr bool is_requirable = true;
+    static constexpr bool is_preferable = true;
+
+    __AGENCY_ANNOTATION
+    constexpr high_t value() const
+    {
+      return *this;
+    }
+  };
+
+  normal_t normal;
+  high_t high;
+};
+
+
+namespace detail
+{
+
+
+template<class T>
+struct is_priority_property
+  : std::integral_constant<
+      bool,
+      std::is_same<T, priority_t::normal_t>::value || std::is_same<T, priority_t::high_t>::value
+    >
+{};
+
+
+} // end detail
+
+
+namespace
+{
+
+
+// define the property object
+
+#ifndef __CUDA_ARCH__
+constexpr priority_t priority{};
+#else
+// CUDA __device__ functions cannot access global variables so make priority a __device__ variable in __device__ code
+const __device__ priority_t priority;
+#endif
+
+
+} // end anonymous namespace
+
+
+} // end agency
+
@@ -0,0 +1,479 @@
+// Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/invoke.hpp>
+#include <agency/execution/executor/detail/adaptors/basic_executor_adaptor.hpp>
+#include <agency/execution/executor/executor_traits/executor_execution_depth.hpp>
+#include <agency/execution/executor/executor_traits/executor_shape.hpp>
+#include <agency/execution/executor/executor_traits/detail/is_bulk_executor.hpp>
+#include <agency/execution/executor/detail/execution_functions/bulk_then_execute.hpp>
+#include <agency/execution/executor/customization_points/make_ready_future.hpp>
+#include <agency/execution/executor/customization_points/unit_shape.hpp>
+#include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/detail/common_bulk_guarantee.hpp>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+
+namespace agency
+{
+
+
+// declare schedule_t for detail::scheduled_executor
+struct schedule_t;
+
+
+namespace detail
+{
+
+
+// is_schedule is specialized below for each of schedule_t's nested properties
+template<class T>
+struct is_schedule : std::false_type {};
+
+
+// scheduled_shared_parameter is the shared parameter of the workers created by scheduled_executor
+// it wraps the shared parameter of the agents created on behalf of the client, and the schedule's
+// state, which workers use to claim ranges of the client's indices
+template<class SharedParameter, class Schedule>
+struct scheduled_shared_parameter
+{
+  SharedParameter shared_parameter;
+  Schedule schedule;
+  size_t num_agents;
+  size_t num_workers;
+  std::atomic<size_t> next_index;
+
+  scheduled_shared_parameter(SharedParameter&& shared_parameter, const Schedule& schedule, size_t num_agents, size_t num_workers)
+    : shared_parameter(std::move(shared_parameter)),
+      schedule(schedule),
+      num_agents(num_agents),
+      num_workers(num_workers),
+      next_index(0)
+  {}
+
+  // the shared parameter is returned from a factory, so it must be movable
+  // it is moved only before any worker begins claiming indices
+  scheduled_shared_parameter(scheduled_shared_parameter&& other)
+    : shared_parameter(std::move(other.shared_parameter)),
+      schedule(other.schedule),
+      num_agents(other.num_agents),
+      num_workers(other.num_workers),
+      next_index(other.next_index.load())
+  {}
+
+  // invokes f(idx) for each index claimed by the given worker
+  template<class Function>
+  void for_each_claimed_index(size_t worker_idx, Function f)
+  {
+    size_t first = 0, last = 0;
+    bool is_first_claim = true;
+
+    while(schedule.claim(worker_idx, num_agents, num_workers, next_index, is_first_claim, first, last))
+    {
+      for(size_t idx = first; idx < last; ++idx)
+      {
+        f(idx);
+      }
+
+      is_first_claim = false;
+    }
+  }
+};
+
+
+template<class SharedParameter, class Schedule>
+struct scheduled_shared_factory
+{
+  template<class SharedFactory>
+  struct type
+  {
+    mutable SharedFactory shared_factory;
+    Schedule schedule;
+    size_t num_agents;
+    size_t num_workers;
+
+    scheduled_shared_parameter<SharedParameter, Schedule> operator()() const
+    {
+      return scheduled_shared_parameter<SharedParameter, Schedule>(shared_factory(), schedule, num_agents, num_workers);
+    }
+  };
+};
+
+
+// scheduled_function is the function each worker created by scheduled_executor invokes
+// each worker executes the client's function for each index it claims from the schedule
+template<class Function>
+struct scheduled_function
+{
+  mutable Function f;
+
+  // this overload is for void predecessors
+  template<class Result, class SharedParameter>
+  void operator()(size_t worker_idx, Result& result, SharedParameter& shared) const
+  {
+    shared.for_each_claimed_index(worker_idx, [&](size_t idx)
+    {
+      agency::detail::invoke(f, idx, result, shared.shared_parameter);
+    });
+  }
+
+  // this overload is for non-void predecessors
+  template<class Predecessor, class Result, class SharedParameter>
+  void operator()(size_t worker_idx, Predecessor& predecessor, Result& result, SharedParameter& shared) const
+  {
+    shared.for_each_claimed_index(worker_idx, [&](size_t idx)
+    {
+      agency::detail::invoke(f, idx, predecessor, result, shared.shared_parameter);
+    });
+  }
+};
+
+
+// scheduled_executor adapts a flat bulk executor with size_t shape to distribute the indices of each launch according to a schedule
+//
+// Rather than creating one agent of the base executor per index, scheduled_executor creates as
+// many workers as the base executor's unit_shape. Each worker invokes the client's function
+// sequentially for each index it claims from the schedule.
+template<class Executor, class Schedule>
+class scheduled_executor : public basic_executor_adaptor<Executor>
+{
+  private:
+    using super_t = basic_executor_adaptor<Executor>;
+
+  public:
+    template<class T>
+    using future = typename super_t::template future<T>;
+
+    using shape_type = size_t;
+
+    __AGENCY_ANNOTATION
+    scheduled_executor(const Executor& ex, const Schedule& schedule) noexcept
+      : super_t{ex}, schedule_(schedule)
+    {}
+
+    // inherit all of basic_executor_adaptor's query members
+    using super_t::query;
+
+    // several agents may be executed sequentially by a single worker,
+    // so a scheduled_executor's agents are at most parallel
+    __AGENCY_ANNOTATION
+    constexpr static common_bulk_guarantee_t<
+      decltype(bulk_guarantee_t::static_query<Executor>()),
+      bulk_guarantee_t::parallel_t
+    >
+      query(const bulk_guarantee_t&)
+    {
+      return common_bulk_guarantee_t<
+        decltype(bulk_guarantee_t::static_query<Executor>()),
+        bulk_guarantee_t::parallel_t
+      >();
+    }
+
+    __AGENCY_ANNOTATION
+    constexpr Schedule query(const schedule_t&) const
+    {
+      return schedule_;
+    }
+
+    // requiring a different schedule replaces this one
+    template<class OtherSchedule,
+             __AGENCY_REQUIRES(
+               is_schedule<OtherSchedule>::value
+             )>
+    __AGENCY_ANNOTATION
+    scheduled_executor<Executor, OtherSchedule> require(const OtherSchedule& schedule) const
+    {
+      return scheduled_executor<Executor, OtherSchedule>{super_t::base_executor(), schedule};
+    }
+
+    __AGENCY_ANNOTATION
+    shape_type unit_shape() const
+    {
+      return agency::unit_shape(super_t::base_executor());
+    }
+
+    template<class Function, class Future, class ResultFactory, class SharedFactory>
+    future<result_of_t<ResultFactory()>>
+      bulk_then_execute(Function f, shape_type shape, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
+    {
+      // create no more workers than there are agents
+      size_t num_workers = std::min<size_t>(shape, unit_shape());
+
+      using shared_parameter_type = result_of_t<SharedFactory()>;
+      using scheduled_shared_factory_type = typename scheduled_shared_factory<shared_parameter_type, Schedule>::template type<SharedFactory>;
+
+      scheduled_shared_factory_type scheduled_factory{shared_factory, schedule_, shape, num_workers};
+
+      return detail::bulk_then_execute(super_t::base_executor(), scheduled_function<Function>{f}, num_workers, predecessor, result_factory, scheduled_factory);
+    }
+
+    template<class Function, class ResultFactory, class SharedFactory>
+    future<result_of_t<ResultFactory()>>
+      bulk_twoway_execute(Function f, shape_type shape, ResultFactory result_factory, SharedFactory shared_factory) const
+    {
+      auto ready = agency::make_ready_future<void>(super_t::base_executor());
+      return bulk_then_execute(f, shape, ready, result_factory, shared_factory);
+    }
+
+  private:
+    Schedule schedule_;
+};
+
+
+template<class Executor>
+using is_schedulable_executor = std::integral_constant<
+  bool,
+  is_bulk_executor<Executor>::value and
+  executor_execution_depth<Executor>::value == 1 and
+  std::is_same<executor_shape_t<Executor>, size_t>::value
+>;
+
+
+} // end detail
+
+
+// schedule_t describes how an executor distributes the indices of a bulk launch among its workers
+//
+// Its nested properties select a schedule:
+//   * static_t divides the indices evenly among the workers before execution begins
+//   * dynamic_t lets workers claim chunks of chunk_size() indices as they become idle
+//   * guided_t lets workers claim chunks which shrink as indices run out
+//
+// static_t is cheapest when every agent costs the same. dynamic_t and guided_t rebalance
+// skewed costs at runtime, and guided_t needs fewer claims than dynamic_t with small chunks.
+struct schedule_t
+{
+  static constexpr bool is_requirable = false;
+  static constexpr bool is_preferable = false;
+
+  // "static" is a keyword, so this property is named static_t and its object static_
+  struct static_t
+  {
+    static constexpr bool is_requirable = true;
+    static constexpr bool is_preferable = true;
+
+    __AGENCY_ANNOTATION
+    constexpr static_t value() const
+    {
+      return *this;
+    }
+
+    // each worker claims a single contiguous block of indices
+    bool claim(size_t worker_idx, size_t num_agents, size_t num_workers, std::atomic<size_t>&, bool is_first_claim, size_t& first, size_t& last) const
+    {
+      if(!is_first_claim) return false;
+
+      first = worker_idx * num_agents / num_workers;
+      last = (worker_idx + 1) * num_agents / num_workers;
+
+      return first < last;
+    }
+
+    template<class Executor,
+             __AGENCY_REQUIRES(detail::is_schedulable_executor<Executor>::value)
+            >
+    __AGENCY_ANNOTATION
+    friend detail::scheduled_executor<Executor, static_t> require(const Executor& ex, static_t s)
+    {
+      return detail::scheduled_executor<Executor, static_t>{ex, s};
+    }
+  };
+
+
+  struct dynamic_t
+  {
+    static constexpr bool is_requirable = true;
+    static constexpr bool is_preferable = true;
+
+    __AGENCY_ANNOTATION
+    constexpr dynamic_t()
+      : chunk_size_(1)
+    {}
+
+    __AGENCY_ANNOTATION
+    constexpr explicit dynamic_t(size_t chunk_size)
+      : chunk_size_(chunk_size > 0 ? chunk_size : 1)
+    {}
+
+    // returns a dynamic schedule whose chunks contain chunk_size indices
+    __AGENCY_ANNOTATION
+    constexpr dynamic_t operator()(size_t chunk_size) const
+    {
+      return dynamic_t(chunk_size);
+    }
+
+    __AGENCY_ANNOTATION
+    constexpr size_t chunk_size() const
+    {
+      return chunk_size_;
+    }
+
+    __AGENCY_ANNOTATION
+    constexpr dynamic_t value() const
+    {
+      return *this;
+    }
+
+    // each claim takes the next chunk_size() indices
+    bool claim(size_t, size_t num_agents, size_t, std::atomic<size_t>& next_index, bool, size_t& first, size_t& last) const
+    {
+      first = next_index.fetch_add(chunk_size_, std::memory_order_relaxed);
+      if(first >= num_agents) return false;
+
+      last = std::min(first + chunk_size_, num_agents);
+      return true;
+    }
+
+    template<class Executor,
+             __AGENCY_REQUIRES(detail::is_schedulable_executor<Executor>::value)
+            >
+    __AGENCY_ANNOTATION
+    friend detail::scheduled_executor<Executor, dynamic_t> require(const Executor& ex, dynamic_t s)
+    {
+      return detail::scheduled_executor<Executor, dynamic_t>{ex, s};
+    }
+
+    private:
+      size_t chunk_size_;
+  };
+
+
+  struct guided_t
+  {
+    static constexpr bool is_requirable = true;
+    static constexpr bool is_preferable = true;
+
+    __AGENCY_ANNOTATION
+    constexpr guided_t()
+      : min_chunk_size_(1)
+    {}
+
+    __AGENCY_ANNOTATION
+    constexpr explicit guided_t(size_t min_chunk_size)
+      : min_chunk_size_(min_chunk_size > 0 ? min_chunk_size : 1)
+    {}
+
+    // returns a guided schedule whose chunks contain no fewer than min_chunk_size indices
+    __AGENCY_ANNOTATION
+    constexpr guided_t operator()(size_t min_chunk_size) const
+    {
+      return guided_t(min_chunk_size);
+    }
+
+    __AGENCY_ANNOTATION
+    constexpr size_t min_chunk_size() const
+    {
+      return min_chunk_size_;
+    }
+
+    __AGENCY_ANNOTATION
+    constexpr guided_t value() const
+    {
+      return *this;
+    }
+
+    // each claim takes a chunk proportional to the number of unclaimed indices,
+    // so early chunks are large and the final chunks balance the workers' loads
+    bool claim(size_t, size_t num_agents, size_t num_workers, std::atomic<size_t>& next_index, bool, size_t& first, size_t& last) const
+    {
+      first = next_index.load(std::memory_order_relaxed);
+
+      do
+      {
+        if(first >= num_agents) return false;
+
+        size_t chunk_size = std::max(min_chunk_size_, (num_agents - first) / (2 * num_workers));
+        last = std::min(first + chunk_size, num_agents);
+      }
+      while(!next_index.compare_exchange_weak(first, last, std::memory_order_relaxed));
+
+      return true;
+    }
+
+    template<class Executor,
+             __AGENCY_REQUIRES(detail::is_schedulable_executor<Executor>::value)
+            >
+    __AGENCY_ANNOTATION
+    friend detail::scheduled_executor<Executor, guided_t> require(const Executor& ex, guided_t s)
+    {
+      return detail::scheduled_executor<Executor, guided_t>{ex, s};
+    }
+
+    private:
+      size_t min_chunk_size_;
+  };
+
+
+  static_t static_;
+  dynamic_t dynamic;
+  guided_t guided;
+};
+
+
+namespace detail
+{
+
+
+template<>
+struct is_schedule<schedule_t::static_t> : std::true_type {};
+
+template<>
+struct is_schedule<schedule_t::dynamic_t> : std::true_type {};
+
+template<>
+struct is_schedule<schedule_t::guided_t> : std::true_type {};
+
+
+} // end detail
+
+
+namespace
+{
+
+
+// define the property object
+
+#ifndef __CUDA_ARCH__
+constexpr schedule_t schedule{};
+#else
+// CUDA __device__ functions cannot access global variables so make schedule a __device__ variable in __device__ code
+const __device__ schedule_t schedule;
+#endif
+
+
+} // end anonymous namespace
+
+
+} // end agency
+
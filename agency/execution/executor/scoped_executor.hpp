@@ -1,7 +1,10 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
 #include <agency/execution/executor/executor_array.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/execution/executor/executor_traits/detail/has_require_member.hpp>
 
 namespace agency
 {
@@ -17,14 +20,37 @@ class scoped_executor : public executor_array<Executor2,Executor1>
     using outer_executor_type = Executor1;
     using inner_executor_type = Executor2;
 
-    scoped_executor(const outer_executor_type&,
+    scoped_executor(const outer_executor_type& outer_ex,
                     const inner_executor_type& inner_ex)
-      : super_t(1, inner_ex)
+      : super_t(outer_ex, 1, inner_ex)
     {}
 
     scoped_executor() :
       scoped_executor(outer_executor_type(), inner_executor_type())
     {}
+
+    using super_t::query;
+
+    // the outer executor creates the groups of agents, so priority applies to it
+    template<class Priority,
+             __AGENCY_REQUIRES(
+               detail::is_priority_property<Priority>::value &&
+               detail::has_require_member<outer_executor_type, Priority>::value
+             )>
+    scoped_executor require(const Priority& prop) const
+    {
+      return scoped_executor(this->outer_executor().require(prop), this->inner_executor(0));
+    }
+
+    template<class Priority,
+             __AGENCY_REQUIRES(
+               detail::is_priority_property<Priority>::value &&
+               detail::has_require_member<outer_executor_type, Priority>::value
+             )>
+    bool query(const Priority& prop) const
+    {
+      return this->outer_executor().query(prop);
+    }
 };
 
 
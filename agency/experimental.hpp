@@ -4,6 +4,7 @@
 #include <agency/experimental/bounded_integer.hpp>
 #include <agency/experimental/ndarray.hpp>
 #include <agency/experimental/optional.hpp>
+#include <agency/experimental/parallel_region.hpp>
 #include <agency/experimental/ranges.hpp>
 #include <agency/experimental/segmented_array.hpp>
 #include <agency/experimental/short_vector.hpp>
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/barrier.hpp>
+#include <agency/detail/concurrency/variant_barrier.hpp>
+#include <agency/detail/concurrency/latch.hpp>
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/detail/concurrency/concurrent_thread_pool.hpp>
+#include <agency/experimental/variant.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+namespace agency
+{
+namespace experimental
+{
+
+
+// parallel_team is the handle through which each member of a parallel region cooperates with its teammates
+//
+// Every member executes the region's body. Work is divided among the members with for_each(),
+// and members synchronize with wait(). Like an OpenMP parallel region, every member must encounter
+// the same sequence of calls to for_each(), single(), and wait().
+class parallel_team
+{
+  public:
+    size_t index() const
+    {
+      return index_;
+    }
+
+    size_t size() const
+    {
+      return barrier_.count();
+    }
+
+    // blocks until every member of the team has called wait()
+    void wait()
+    {
+      barrier_.arrive_and_wait(index_);
+    }
+
+    // invokes f(i) for each i in [0, n), dividing the indices among the members of the team,
+    // then waits for every member to finish its indices
+    template<class Function>
+    void for_each(size_t n, Function&& f)
+    {
+      // each member receives a contiguous block of indices
+      size_t first = index() * n / size();
+      size_t last = (index() + 1) * n / size();
+
+      for(size_t i = first; i < last; ++i)
+      {
+        f(i);
+      }
+
+      wait();
+    }
+
+    // invokes f() on a single member of the team, then waits for it to finish
+    template<class Function>
+    void single(Function&& f)
+    {
+      if(index() == 0)
+      {
+        f();
+      }
+
+      wait();
+    }
+
+  private:
+    template<class Function>
+    friend void parallel_region(size_t team_size, Function body);
+
+    using barrier_type = agency::detail::variant_barrier<agency::detail::spinning_barrier, agency::detail::barrier>;
+
+    parallel_team(size_t index, barrier_type& barrier)
+      : index_(index),
+        barrier_(barrier)
+    {}
+
+    size_t index_;
+    barrier_type& barrier_;
+};
+
+
+// parallel_region() invokes body(team) on each member of a team of team_size threads,
+// and returns when every member has returned
+//
+// Unlike a loop of calls to bulk_invoke(par(n), ...), a parallel region launches its team once.
+// The iterations of a loop inside the body are separated only by the team's barrier, so they
+// pay neither for the creation of a new group nor for the fulfillment of a future.
+//
+// The calling thread becomes member 0 of the team. The remaining members execute on persistent
+// threads which are guaranteed to progress concurrently, as the team's barrier requires.
+// For this reason, the team does not execute on parallel_thread_pool_executor: its agents are guaranteed only
+// parallel progress, so members waiting at the barrier could occupy every worker of the system thread pool
+// while their teammates remain queued behind them. Instead, the remaining members execute on the threads of
+// the system concurrent thread pool, which concurrent_executor also uses, and which dedicates one thread to each member.
+//
+// If a member exits body with an exception, the first such exception is rethrown by parallel_region().
+// Because its teammates may still be waiting on it, a member may only exit body via an
+// exception if every member does so.
+template<class Function>
+void parallel_region(size_t team_size, Function body)
+{
+  if(team_size == 0) return;
+
+  using barrier_type = parallel_team::barrier_type;
+
+  // spin only when each member may have a hardware thread of its own
+  size_t barrier_index = team_size <= std::max(1u, std::thread::hardware_concurrency()) ? 0 : 1;
+  barrier_type barrier(barrier_index, team_size);
+
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  auto member = [&](size_t index)
+  {
+    parallel_team team(index, barrier);
+
+    try
+    {
+      body(team);
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+
+      if(!exception)
+      {
+        exception = std::current_exception();
+      }
+    }
+  };
+
+  if(team_size > 1)
+  {
+    // the members share ownership of the latch, because the last member to count down may still be inside
+    // count_down() after the calling thread has observed the latch become ready and returned
+    auto finished = std::make_shared<agency::detail::latch>(team_size - 1);
+
+    agency::detail::system_concurrent_thread_pool().bulk_submit([&member, finished](size_t index)
+    {
+      member(index + 1);
+      finished->count_down(1);
+    },
+    team_size - 1);
+
+    member(0);
+
+    finished->wait();
+  }
+  else
+  {
+    member(0);
+  }
+
+  if(exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+
+// this overload of parallel_region() creates as many members as the system thread pool,
+// which executes the agents of parallel_thread_pool_executor
+template<class Function>
+void parallel_region(Function body)
+{
+  experimental::parallel_region(agency::detail::system_thread_pool().size(), body);
+}
+
+
+} // end experimental
+} // end agency
+
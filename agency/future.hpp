@@ -8,6 +8,7 @@
 #include <agency/future/future_traits/future_rebind_value.hpp>
 #include <agency/future/future_traits/future_result.hpp>
 #include <agency/future/detail/monadic_then.hpp>
+#include <agency/future/detail/pooled_async.hpp>
 #include <agency/detail/has_member.hpp>
 #include <agency/detail/unit.hpp>
 
@@ -123,10 +124,10 @@ template<class T, class Function>
 std::future<detail::result_of_t<Function(std::future<T>&)>>
   then(std::future<T>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::future<T>&& fut, Function&& f)
+  return detail::pooled_async(policy, [](std::future<T>& fut, detail::decay_t<Function>& f)
   {
     fut.wait();
-    return std::forward<Function>(f)(fut);
+    return f(fut);
   },
   std::move(fut),
   std::forward<Function>(f)
@@ -148,10 +149,10 @@ template<class T, class Function>
 std::future<detail::result_of_t<Function(std::shared_future<T>&)>>
   then(std::shared_future<T>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::shared_future<T>&& fut, Function&& f)
+  return detail::pooled_async(policy, [](std::shared_future<T>& fut, detail::decay_t<Function>& f)
   {
     fut.wait();
-    return std::forward<Function>(f)(fut);
+    return f(fut);
   },
   std::move(fut),
   std::forward<Function>(f)
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/execution/blocking_region.hpp>
+
+#include <future>
+#include <chrono>
+#include <utility>
+
+
+namespace agency
+{
+
+
+template<class T>
+class shared_future;
+
+
+namespace detail
+{
+
+
+template<class T, class Function>
+void invoke_when_ready(shared_future<T> fut, Function f);
+
+
+namespace invoke_when_ready_detail
+{
+
+
+template<class Future>
+using wait_for_member_t = decltype(std::declval<const Future&>().wait_for(std::chrono::seconds(0)));
+
+template<class Future>
+using has_wait_for_member = is_detected_exact<std::future_status, wait_for_member_t, Future>;
+
+
+template<class Future,
+         __AGENCY_REQUIRES(has_wait_for_member<Future>::value)
+        >
+bool is_ready(const Future& fut)
+{
+  return fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+
+template<class Future,
+         __AGENCY_REQUIRES(!has_wait_for_member<Future>::value)
+        >
+bool is_ready(const Future&)
+{
+  // we have no way to query the readiness of this kind of future
+  return false;
+}
+
+
+// this functor waits on a future and then invokes a function
+template<class Future, class Function>
+struct wait_and_invoke
+{
+  mutable Future fut;
+  mutable Function f;
+
+  void operator()() const
+  {
+    {
+      // a pool's worker which blocks on fut lets the pool start a spare worker in the meantime
+      agency::this_thread::blocking_region region;
+      fut.wait();
+    }
+
+    f();
+  }
+};
+
+
+} // end invoke_when_ready_detail
+
+
+// invoke_when_ready() arranges for f() to be invoked once fut becomes ready, even if fut becomes ready with an exception,
+// without blocking the calling thread on fut
+//
+// Future must be copyable (e.g., a shared future) so that f may consume its result by
+// capturing a copy of fut
+//
+// f is invoked:
+//   1. by the thread which makes fut ready, if fut is an agency::shared_future, or
+//   2. immediately in the calling thread, if fut is already ready, or
+//   3. by a task which waits on fut, otherwise
+//
+// other futures' .then() is not used because a continuation registered with .then() may be skipped
+// when fut becomes ready with an exception, which would leave f uninvoked
+//
+// submit(task) must arrange for task() to be invoked by a thread which may block on fut, for example a pool's worker
+// the task waits inside a blocking_region, so a pool which supports spare workers replaces the waiting worker
+template<class Future, class Function, class Submit>
+void invoke_when_ready(Future fut, Function f, Submit submit)
+{
+  if(invoke_when_ready_detail::is_ready(fut))
+  {
+    f();
+  }
+  else
+  {
+    // a task submitted by the caller waits on fut
+    // rather than a thread of our own, which could outlive the objects f references
+    submit(invoke_when_ready_detail::wait_and_invoke<Future,Function>{std::move(fut), std::move(f)});
+  }
+}
+
+
+template<class T, class Function, class Submit>
+void invoke_when_ready(shared_future<T> fut, Function f, Submit)
+{
+  detail::invoke_when_ready(std::move(fut), std::move(f));
+}
+
+
+} // end detail
+} // end agency
+
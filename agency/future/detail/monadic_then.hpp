@@ -29,6 +29,7 @@
 #include <agency/detail/config.hpp>
 #include <agency/detail/type_traits.hpp>
 #include <agency/future/future_traits/detail/has_then_member.hpp>
+#include <agency/future/detail/pooled_async.hpp>
 #include <utility>
 #include <future>
 
@@ -43,10 +44,10 @@ template<class T, class Function>
 std::future<detail::result_of_t<Function(T&)>>
   monadic_then(std::future<T>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::future<T>&& fut, Function&& f)
+  return detail::pooled_async(policy, [](std::future<T>& fut, detail::decay_t<Function>& f)
   {
     T arg = fut.get();
-    return std::forward<Function>(f)(arg);
+    return f(arg);
   },
   std::move(fut),
   std::forward<Function>(f)
@@ -58,10 +59,10 @@ template<class Function>
 std::future<detail::result_of_t<Function()>>
   monadic_then(std::future<void>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::future<void>&& fut, Function&& f)
+  return detail::pooled_async(policy, [](std::future<void>& fut, detail::decay_t<Function>& f)
   {
     fut.get();
-    return std::forward<Function>(f)();
+    return f();
   },
   std::move(fut),
   std::forward<Function>(f)
@@ -82,10 +83,10 @@ template<class T, class Function>
 std::future<detail::result_of_t<Function(T&)>>
   monadic_then(std::shared_future<T>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::shared_future<T>&& fut, Function&& f)
+  return detail::pooled_async(policy, [](std::shared_future<T>& fut, detail::decay_t<Function>& f)
   {
     T& arg = const_cast<T&>(fut.get());
-    return std::forward<Function>(f)(arg);
+    return f(arg);
   },
   std::move(fut),
   std::forward<Function>(f)
@@ -97,10 +98,10 @@ template<class Function>
 std::future<detail::result_of_t<Function()>>
   monadic_then(std::shared_future<void>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::shared_future<void>&& fut, Function&& f)
+  return detail::pooled_async(policy, [](std::shared_future<void>& fut, detail::decay_t<Function>& f)
   {
     fut.get();
-    return std::forward<Function>(f)();
+    return f();
   },
   std::move(fut),
   std::forward<Function>(f)
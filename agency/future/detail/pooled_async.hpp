@@ -0,0 +1,49 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/concurrency/concurrent_thread_pool.hpp>
+
+#include <functional>
+#include <future>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// pooled_async() is like std::async(), except that when policy permits std::launch::async,
+// f(args...) executes on a thread of the system concurrent thread pool rather than on a new thread
+// the pool reuses an idle thread when one exists, so a continuation of a std::future does not create a thread of its own
+//
+// like std::async(), f and args are decay-copied, but f receives the copies of args as lvalues
+// unlike the result of std::async(), the returned future does not block in its destructor
+template<class Function, class... Args>
+std::future<result_of_t<decay_t<Function>(decay_t<Args>&...)>>
+  pooled_async(std::launch policy, Function&& f, Args&&... args)
+{
+  using result_type = result_of_t<decay_t<Function>(decay_t<Args>&...)>;
+
+  auto bound = std::bind(std::forward<Function>(f), std::forward<Args>(args)...);
+
+  if((policy & std::launch::async) != std::launch::async)
+  {
+    return std::async(std::launch::deferred, std::move(bound));
+  }
+
+  std::packaged_task<result_type()> task(std::move(bound));
+  std::future<result_type> result = task.get_future();
+
+  // the task may block on a predecessor, so it requires a thread of its own
+  system_concurrent_thread_pool().submit(std::move(task));
+
+  return result;
+}
+
+
+} // end detail
+} // end agency
+
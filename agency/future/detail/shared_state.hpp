@@ -0,0 +1,633 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/memory/detail/resource/thread_local_cached_resource.hpp>
+#include <agency/detail/concurrency/this_worker.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// shared_state_continuation is a node in the intrusive list of continuations registered
+// with a shared_state_base
+// its invoke_function is called exactly once, by the thread which makes the state ready
+struct shared_state_continuation
+{
+  using function_type = void(*)(shared_state_continuation*);
+
+  explicit shared_state_continuation(function_type f)
+    : next(nullptr), invoke_function(f)
+  {}
+
+  void invoke()
+  {
+    invoke_function(this);
+  }
+
+  shared_state_continuation* next;
+  function_type invoke_function;
+};
+
+
+// shared_state_base implements the reference counting, readiness, and continuation
+// machinery shared by all types of shared_state
+//
+// The state's list of continuations doubles as its readiness flag: once the state becomes ready,
+// the head of the list is permanently replaced with a sentinel. So, registering a continuation
+// and making the state ready are each a single atomic operation, and neither ever takes a lock.
+class shared_state_base
+{
+  public:
+    shared_state_base()
+      : reference_count_(1),
+        continuations_(nullptr)
+    {}
+
+    shared_state_base(const shared_state_base&) = delete;
+
+    virtual ~shared_state_base() {}
+
+    // shared states are allocated from a per-thread cache
+    // because ~shared_state_base() is virtual, num_bytes is the size of the most derived type
+    static void* operator new(std::size_t num_bytes)
+    {
+      return resource_type().allocate(num_bytes);
+    }
+
+    static void operator delete(void* ptr, std::size_t num_bytes)
+    {
+      resource_type().deallocate(ptr, num_bytes);
+    }
+
+    void add_reference()
+    {
+      reference_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void remove_reference()
+    {
+      if(reference_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        delete this;
+      }
+    }
+
+    bool is_ready() const
+    {
+      return continuations_.load(std::memory_order_acquire) == ready_sentinel();
+    }
+
+    // arranges for c to be invoked once this state becomes ready
+    // if this state is already ready, c is invoked immediately by the calling thread
+    void add_continuation(shared_state_continuation* c)
+    {
+      shared_state_continuation* head = continuations_.load(std::memory_order_acquire);
+
+      do
+      {
+        if(head == ready_sentinel())
+        {
+          c->invoke();
+          return;
+        }
+
+        c->next = head;
+      }
+      while(!continuations_.compare_exchange_weak(head, c, std::memory_order_acq_rel, std::memory_order_acquire));
+    }
+
+    void wait()
+    {
+      // spin briefly before blocking, because the state often becomes ready soon
+      for(int i = 0; i < 64; ++i)
+      {
+        if(is_ready()) return;
+      }
+
+      waiter w;
+      add_continuation(&w);
+
+      if(this_worker::is_worker())
+      {
+        // a worker which blocks deprives its pool of a thread, and the state may be waiting on a task queued in that pool
+        // so, execute queued tasks until the state is ready
+        while(!w.is_notified())
+        {
+          if(!this_worker::try_execute_one_task())
+          {
+            // there is nothing to help with at the moment, so block briefly before looking again
+            w.wait_for(std::chrono::microseconds(100));
+          }
+        }
+      }
+      else
+      {
+        w.wait();
+      }
+    }
+
+    // waits until this state becomes ready or deadline passes, and returns whether this state is ready
+    template<class Clock, class Duration>
+    bool wait_until(const std::chrono::time_point<Clock,Duration>& deadline)
+    {
+      if(is_ready()) return true;
+
+      std::shared_ptr<timed_waiter::notification> notification = std::make_shared<timed_waiter::notification>();
+      add_continuation(new timed_waiter(notification));
+
+      std::unique_lock<std::mutex> lock(notification->mutex);
+      return notification->cv.wait_until(lock, deadline, [&]{ return notification->is_ready; });
+    }
+
+    // precondition: !is_ready()
+    void set_exception(std::exception_ptr e)
+    {
+      exception_ = e;
+      become_ready();
+    }
+
+    // precondition: is_ready()
+    const std::exception_ptr& exception() const
+    {
+      return exception_;
+    }
+
+    // precondition: is_ready()
+    void rethrow_if_exceptional() const
+    {
+      if(exception_)
+      {
+        std::rethrow_exception(exception_);
+      }
+    }
+
+  protected:
+    // publishes the result of this state and invokes its continuations in the order they were registered
+    // precondition: !is_ready()
+    void become_ready()
+    {
+      shared_state_continuation* head = continuations_.exchange(ready_sentinel(), std::memory_order_acq_rel);
+
+      // the list was built by pushing onto its front, so reverse it
+      shared_state_continuation* reversed = nullptr;
+      while(head)
+      {
+        shared_state_continuation* next = head->next;
+        head->next = reversed;
+        reversed = head;
+        head = next;
+      }
+
+      while(reversed)
+      {
+        // read next before invoking, because the invocation may destroy the node
+        shared_state_continuation* next = reversed->next;
+        reversed->invoke();
+        reversed = next;
+      }
+    }
+
+  private:
+    using resource_type = thread_local_cached_resource<>;
+
+    // a waiter blocks a thread until the state it is registered with becomes ready
+    struct waiter : shared_state_continuation
+    {
+      waiter()
+        : shared_state_continuation(notify),
+          is_ready(false)
+      {}
+
+      static void notify(shared_state_continuation* self_)
+      {
+        waiter* self = static_cast<waiter*>(self_);
+
+        // notify while holding the lock, because the waiter may be destroyed as soon as it observes is_ready
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->is_ready = true;
+        self->cv.notify_one();
+      }
+
+      void wait()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]{ return is_ready; });
+      }
+
+      template<class Rep, class Period>
+      void wait_for(const std::chrono::duration<Rep,Period>& timeout)
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, timeout, [this]{ return is_ready; });
+      }
+
+      bool is_notified()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        return is_ready;
+      }
+
+      std::mutex mutex;
+      std::condition_variable cv;
+      bool is_ready;
+    };
+
+    // a timed_waiter notifies a caller of wait_until(), which may stop waiting before the state becomes ready
+    // so, unlike a waiter, it shares its notification with the caller, and it is allocated separately and
+    // destroys itself once it is invoked
+    struct timed_waiter : shared_state_continuation
+    {
+      struct notification
+      {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool is_ready = false;
+      };
+
+      explicit timed_waiter(const std::shared_ptr<notification>& n)
+        : shared_state_continuation(notify),
+          notification_(n)
+      {}
+
+      static void notify(shared_state_continuation* self_)
+      {
+        timed_waiter* self = static_cast<timed_waiter*>(self_);
+
+        {
+          std::lock_guard<std::mutex> lock(self->notification_->mutex);
+          self->notification_->is_ready = true;
+          self->notification_->cv.notify_all();
+        }
+
+        delete self;
+      }
+
+      std::shared_ptr<notification> notification_;
+    };
+
+    static shared_state_continuation* ready_sentinel()
+    {
+      // no continuation lives at this address
+      return reinterpret_cast<shared_state_continuation*>(std::uintptr_t(1));
+    }
+
+    std::atomic<std::size_t> reference_count_;
+    std::atomic<shared_state_continuation*> continuations_;
+    std::exception_ptr exception_;
+};
+
+
+template<class T>
+class shared_state : public shared_state_base
+{
+  public:
+    using value_type = T;
+
+    shared_state()
+      : has_value_(false)
+    {}
+
+    ~shared_state()
+    {
+      if(has_value_)
+      {
+        ptr()->~T();
+      }
+    }
+
+    // precondition: !is_ready()
+    template<class... Args>
+    void set_value(Args&&... args)
+    {
+      construct_value(std::forward<Args>(args)...);
+      become_ready();
+    }
+
+    // constructs the value without making this state ready
+    // precondition: !is_ready()
+    template<class... Args>
+    void construct_value(Args&&... args)
+    {
+      ::new(ptr()) T(std::forward<Args>(args)...);
+      has_value_ = true;
+    }
+
+    // precondition: is_ready()
+    T& value()
+    {
+      rethrow_if_exceptional();
+      return *ptr();
+    }
+
+    // precondition: is_ready()
+    T move_value()
+    {
+      return std::move(value());
+    }
+
+  private:
+    T* ptr()
+    {
+      return reinterpret_cast<T*>(&storage_);
+    }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+    bool has_value_;
+};
+
+
+template<>
+class shared_state<void> : public shared_state_base
+{
+  public:
+    using value_type = void;
+
+    void set_value()
+    {
+      become_ready();
+    }
+
+    void construct_value() {}
+
+    // precondition: is_ready()
+    void value()
+    {
+      rethrow_if_exceptional();
+    }
+
+    // precondition: is_ready()
+    void move_value()
+    {
+      rethrow_if_exceptional();
+    }
+};
+
+
+// shared_state_ptr is an intrusive smart pointer to a shared_state
+template<class State>
+class shared_state_ptr
+{
+  public:
+    shared_state_ptr()
+      : ptr_(nullptr)
+    {}
+
+    // adopts the reference owned by the caller
+    explicit shared_state_ptr(State* ptr)
+      : ptr_(ptr)
+    {}
+
+    shared_state_ptr(const shared_state_ptr& other)
+      : ptr_(other.ptr_)
+    {
+      if(ptr_) ptr_->add_reference();
+    }
+
+    shared_state_ptr(shared_state_ptr&& other) noexcept
+      : ptr_(other.ptr_)
+    {
+      other.ptr_ = nullptr;
+    }
+
+    // converts a pointer to a derived state into a pointer to its base
+    template<class OtherState,
+             class = typename std::enable_if<
+               std::is_convertible<OtherState*,State*>::value
+             >::type>
+    shared_state_ptr(shared_state_ptr<OtherState>&& other)
+      : ptr_(other.release())
+    {}
+
+    ~shared_state_ptr()
+    {
+      reset();
+    }
+
+    shared_state_ptr& operator=(shared_state_ptr other)
+    {
+      std::swap(ptr_, other.ptr_);
+      return *this;
+    }
+
+    State* get() const
+    {
+      return ptr_;
+    }
+
+    State* operator->() const
+    {
+      return ptr_;
+    }
+
+    State& operator*() const
+    {
+      return *ptr_;
+    }
+
+    explicit operator bool() const
+    {
+      return ptr_ != nullptr;
+    }
+
+    // returns the pointer without releasing its reference
+    State* release()
+    {
+      State* result = ptr_;
+      ptr_ = nullptr;
+      return result;
+    }
+
+    void reset()
+    {
+      if(ptr_)
+      {
+        ptr_->remove_reference();
+        ptr_ = nullptr;
+      }
+    }
+
+  private:
+    State* ptr_;
+};
+
+
+template<class State, class... Args>
+shared_state_ptr<State> make_shared_state(Args&&... args)
+{
+  return shared_state_ptr<State>(new State(std::forward<Args>(args)...));
+}
+
+
+// continuation_state is both the shared state of a continuation's result and the node
+// registered with the shared state of the continuation's predecessor
+// so, attaching a continuation requires a single allocation
+template<class Result, class Predecessor, class Function>
+class continuation_state : public shared_state<Result>, private shared_state_continuation
+{
+  public:
+    continuation_state(Function&& f)
+      : shared_state_continuation(invoke_continuation),
+        has_function_(true)
+    {
+      ::new(&function_storage_) Function(std::move(f));
+    }
+
+    ~continuation_state()
+    {
+      destroy_function();
+    }
+
+    // attaches a new continuation_state to predecessor and returns it
+    static shared_state_ptr<shared_state<Result>> attach(const shared_state_ptr<shared_state<Predecessor>>& predecessor, Function f)
+    {
+      shared_state_ptr<continuation_state> result = make_shared_state<continuation_state>(std::move(f));
+
+      // the registration owns a reference to both the predecessor and the continuation
+      predecessor->add_reference();
+      result->predecessor_ = predecessor.get();
+      result->add_reference();
+      predecessor->add_continuation(result.get());
+
+      return result;
+    }
+
+  private:
+    static void invoke_continuation(shared_state_continuation* self_)
+    {
+      // adopt the references owned by the registration
+      shared_state_ptr<continuation_state> self(static_cast<continuation_state*>(self_));
+      shared_state_ptr<shared_state<Predecessor>> predecessor(self->predecessor_);
+
+      // only the invocation of the function is guarded, because publishing the result invokes the continuations
+      // of this state, and an exception escaping one of those must not be published as this state's exception
+      std::exception_ptr exception;
+      try
+      {
+        predecessor->rethrow_if_exceptional();
+        self->invoke_and_construct_value(*predecessor);
+      }
+      catch(...)
+      {
+        exception = std::current_exception();
+      }
+
+      // the function is destroyed before the result is published, because it may own resources
+      // whose release the continuation's consumers expect to observe
+      self->destroy_function();
+
+      if(exception)
+      {
+        self->set_exception(exception);
+      }
+      else
+      {
+        self->become_ready();
+      }
+    }
+
+    template<class T>
+    void invoke_and_construct_value(shared_state<T>& predecessor)
+    {
+      invoke_and_construct_value_impl(std::is_void<Result>(), predecessor.value());
+    }
+
+    void invoke_and_construct_value(shared_state<void>&)
+    {
+      invoke_and_construct_value_impl(std::is_void<Result>());
+    }
+
+    template<class... Args>
+    void invoke_and_construct_value_impl(std::true_type, Args&... args)
+    {
+      function()(args...);
+    }
+
+    template<class... Args>
+    void invoke_and_construct_value_impl(std::false_type, Args&... args)
+    {
+      this->construct_value(function()(args...));
+    }
+
+    Function& function()
+    {
+      return *reinterpret_cast<Function*>(&function_storage_);
+    }
+
+    void destroy_function()
+    {
+      if(has_function_)
+      {
+        function().~Function();
+        has_function_ = false;
+      }
+    }
+
+    typename std::aligned_storage<sizeof(Function), alignof(Function)>::type function_storage_;
+    bool has_function_;
+    shared_state<Predecessor>* predecessor_;
+};
+
+
+// when_ready_continuation invokes a function once the state it is attached to becomes ready,
+// whether or not that state is exceptional
+template<class Function>
+class when_ready_continuation : private shared_state_continuation
+{
+  public:
+    static void attach(shared_state_base& state, Function f)
+    {
+      state.add_continuation(new when_ready_continuation(std::move(f)));
+    }
+
+    static void* operator new(std::size_t num_bytes)
+    {
+      return resource_type().allocate(num_bytes);
+    }
+
+    static void operator delete(void* ptr, std::size_t num_bytes)
+    {
+      resource_type().deallocate(ptr, num_bytes);
+    }
+
+  private:
+    using resource_type = thread_local_cached_resource<>;
+
+    when_ready_continuation(Function&& f)
+      : shared_state_continuation(invoke_and_delete),
+        f_(std::move(f))
+    {}
+
+    static void invoke_and_delete(shared_state_continuation* self_)
+    {
+      when_ready_continuation* self = static_cast<when_ready_continuation*>(self_);
+
+      Function f = std::move(self->f_);
+      delete self;
+
+      f();
+    }
+
+    Function f_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/future.hpp>
+#include <agency/future/detail/shared_state.hpp>
+#include <agency/future/detail/invoke_when_ready.hpp>
+#include <agency/execution/executor/detail/execution_functions/then_execute.hpp>
+
+#include <chrono>
+#include <future>
+#include <utility>
+
+
+namespace agency
+{
+
+
+template<class T>
+class promise;
+
+template<class T>
+class shared_future;
+
+
+namespace detail
+{
+
+
+template<class T, class Function>
+void invoke_when_ready(shared_future<T> fut, Function f);
+
+
+} // end detail
+
+
+// future is a lightweight alternative to std::future for use with Agency's host executors
+//
+// Its shared state is intrusively reference counted and is allocated from a per-thread cache.
+// Attaching a continuation with .then() never creates a thread: the continuation is invoked
+// inline by the thread which makes the future ready, or immediately, if the future is already ready.
+// To execute a continuation elsewhere, pass an executor to .then().
+template<class T>
+class future
+{
+  private:
+    using state_type = detail::shared_state<T>;
+    using state_ptr_type = detail::shared_state_ptr<state_type>;
+
+  public:
+    // Default constructor creates an invalid future
+    // Postcondition: !valid()
+    future() = default;
+
+    future(future&&) = default;
+
+    future& operator=(future&&) = default;
+
+    template<class... Args,
+             __AGENCY_REQUIRES(
+               std::is_constructible<T,Args&&...>::value
+             )>
+    static future make_ready(Args&&... args)
+    {
+      state_ptr_type state = detail::make_shared_state<state_type>();
+      state->set_value(std::forward<Args>(args)...);
+      return future(std::move(state));
+    }
+
+    bool valid() const
+    {
+      return static_cast<bool>(state_);
+    }
+
+    bool is_ready() const
+    {
+      return valid() && state_->is_ready();
+    }
+
+    void wait() const
+    {
+      check_valid();
+      state_->wait();
+    }
+
+    template<class Rep, class Period>
+    std::future_status wait_for(const std::chrono::duration<Rep,Period>& timeout) const
+    {
+      return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<class Clock, class Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock,Duration>& deadline) const
+    {
+      check_valid();
+      return state_->wait_until(deadline) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    // waits for the result and moves it out of the shared state
+    // postcondition: !valid()
+    T get()
+    {
+      wait();
+
+      state_ptr_type state = std::move(state_);
+      return state->move_value();
+    }
+
+    // postcondition: !valid()
+    shared_future<T> share()
+    {
+      return shared_future<T>(std::move(*this));
+    }
+
+    // attaches a continuation which receives the result of *this as an lvalue
+    // postcondition: !valid()
+    template<class Function>
+    future<detail::result_of_continuation_t<detail::decay_t<Function>, future>>
+      then(Function&& f)
+    {
+      check_valid();
+
+      using result_type = detail::result_of_continuation_t<detail::decay_t<Function>, future>;
+      using continuation_state_type = detail::continuation_state<result_type, T, detail::decay_t<Function>>;
+
+      state_ptr_type predecessor = std::move(state_);
+      return future<result_type>(continuation_state_type::attach(predecessor, std::forward<Function>(f)));
+    }
+
+    // attaches a continuation which executes on the given executor
+    // postcondition: !valid()
+    template<class Executor, class Function>
+    executor_future_t<Executor, detail::result_of_continuation_t<detail::decay_t<Function>, future>>
+      then(const Executor& exec, Function&& f)
+    {
+      check_valid();
+
+      return detail::then_execute(exec, std::forward<Function>(f), *this);
+    }
+
+  private:
+    template<class> friend class future;
+    template<class> friend class shared_future;
+    template<class> friend class promise;
+
+    explicit future(state_ptr_type&& state)
+      : state_(std::move(state))
+    {}
+
+    void check_valid() const
+    {
+      if(!valid())
+      {
+        throw std::future_error(std::future_errc::no_state);
+      }
+    }
+
+    state_ptr_type state_;
+};
+
+
+template<>
+class future<void>
+{
+  private:
+    using state_type = detail::shared_state<void>;
+    using state_ptr_type = detail::shared_state_ptr<state_type>;
+
+  public:
+    // Default constructor creates an invalid future
+    // Postcondition: !valid()
+    future() = default;
+
+    future(future&&) = default;
+
+    future& operator=(future&&) = default;
+
+    static future make_ready()
+    {
+      state_ptr_type state = detail::make_shared_state<state_type>();
+      state->set_value();
+      return future(std::move(state));
+    }
+
+    bool valid() const
+    {
+      return static_cast<bool>(state_);
+    }
+
+    bool is_ready() const
+    {
+      return valid() && state_->is_ready();
+    }
+
+    void wait() const
+    {
+      check_valid();
+      state_->wait();
+    }
+
+    template<class Rep, class Period>
+    std::future_status wait_for(const std::chrono::duration<Rep,Period>& timeout) const
+    {
+      return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<class Clock, class Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock,Duration>& deadline) const
+    {
+      check_valid();
+      return state_->wait_until(deadline) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    // postcondition: !valid()
+    void get()
+    {
+      wait();
+
+      state_ptr_type state = std::move(state_);
+      state->move_value();
+    }
+
+    // postcondition: !valid()
+    inline shared_future<void> share();
+
+    // postcondition: !valid()
+    template<class Function>
+    future<detail::result_of_continuation_t<detail::decay_t<Function>, future>>
+      then(Function&& f)
+    {
+      check_valid();
+
+      using result_type = detail::result_of_continuation_t<detail::decay_t<Function>, future>;
+      using continuation_state_type = detail::continuation_state<result_type, void, detail::decay_t<Function>>;
+
+      state_ptr_type predecessor = std::move(state_);
+      return future<result_type>(continuation_state_type::attach(predecessor, std::forward<Function>(f)));
+    }
+
+    // postcondition: !valid()
+    template<class Executor, class Function>
+    executor_future_t<Executor, detail::result_of_continuation_t<detail::decay_t<Function>, future>>
+      then(const Executor& exec, Function&& f)
+    {
+      check_valid();
+
+      return detail::then_execute(exec, std::forward<Function>(f), *this);
+    }
+
+  private:
+    template<class> friend class future;
+    template<class> friend class shared_future;
+    template<class> friend class promise;
+
+    explicit future(state_ptr_type&& state)
+      : state_(std::move(state))
+    {}
+
+    void check_valid() const
+    {
+      if(!valid())
+      {
+        throw std::future_error(std::future_errc::no_state);
+      }
+    }
+
+    state_ptr_type state_;
+};
+
+
+// shared_future is the copyable counterpart of future
+// Unlike future, shared_future's .then() leaves *this valid
+template<class T>
+class shared_future
+{
+  private:
+    using state_type = detail::shared_state<T>;
+    using state_ptr_type = detail::shared_state_ptr<state_type>;
+
+  public:
+    // Default constructor creates an invalid shared_future
+    // Postcondition: !valid()
+    shared_future() = default;
+
+    shared_future(const shared_future&) = default;
+
+    shared_future(shared_future&&) = default;
+
+    // postcondition: !other.valid()
+    shared_future(future<T>&& other)
+      : state_(std::move(other.state_))
+    {}
+
+    shared_future& operator=(const shared_future&) = default;
+
+    shared_future& operator=(shared_future&&) = default;
+
+    template<class... Args>
+    static shared_future make_ready(Args&&... args)
+    {
+      return future<T>::make_ready(std::forward<Args>(args)...);
+    }
+
+    bool valid() const
+    {
+      return static_cast<bool>(state_);
+    }
+
+    bool is_ready() const
+    {
+      return valid() && state_->is_ready();
+    }
+
+    void wait() const
+    {
+      check_valid();
+      state_->wait();
+    }
+
+    template<class Rep, class Period>
+    std::future_status wait_for(const std::chrono::duration<Rep,Period>& timeout) const
+    {
+      return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<class Clock, class Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock,Duration>& deadline) const
+    {
+      check_valid();
+      return state_->wait_until(deadline) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    // returns const T& for non-void T, and void otherwise
+    typename std::add_lvalue_reference<const T>::type get() const
+    {
+      wait();
+
+      return state_->value();
+    }
+
+    shared_future share() const
+    {
+      return *this;
+    }
+
+    template<class Function>
+    future<detail::result_of_continuation_t<detail::decay_t<Function>, shared_future>>
+      then(Function&& f) const
+    {
+      check_valid();
+
+      using result_type = detail::result_of_continuation_t<detail::decay_t<Function>, shared_future>;
+      using continuation_state_type = detail::continuation_state<result_type, T, detail::decay_t<Function>>;
+
+      return future<result_type>(continuation_state_type::attach(state_, std::forward<Function>(f)));
+    }
+
+    template<class Executor, class Function>
+    executor_future_t<Executor, detail::result_of_continuation_t<detail::decay_t<Function>, shared_future>>
+      then(const Executor& exec, Function&& f) const
+    {
+      check_valid();
+
+      shared_future self = *this;
+      return detail::then_execute(exec, std::forward<Function>(f), self);
+    }
+
+  private:
+    template<class U, class Function>
+    friend void detail::invoke_when_ready(shared_future<U> fut, Function f);
+
+    void check_valid() const
+    {
+      if(!valid())
+      {
+        throw std::future_error(std::future_errc::no_state);
+      }
+    }
+
+    state_ptr_type state_;
+};
+
+
+inline shared_future<void> future<void>::share()
+{
+  return shared_future<void>(std::move(*this));
+}
+
+
+namespace detail
+{
+
+
+// this overload of invoke_when_ready() invokes f even if fut becomes ready with an exception
+template<class T, class Function>
+void invoke_when_ready(shared_future<T> fut, Function f)
+{
+  fut.check_valid();
+
+  when_ready_continuation<Function>::attach(*fut.state_, std::move(f));
+}
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/future/future.hpp>
+#include <agency/future/detail/shared_state.hpp>
+
+#include <exception>
+#include <future>
+#include <utility>
+
+
+namespace agency
+{
+
+
+// promise is the producer end of agency::future
+// Fulfilling a promise invokes the continuations attached to its future in the fulfilling thread.
+// If a promise is destroyed before it is fulfilled, its future becomes ready with a std::future_error
+// whose code is std::future_errc::broken_promise.
+template<class T>
+class promise
+{
+  private:
+    using state_type = detail::shared_state<T>;
+    using state_ptr_type = detail::shared_state_ptr<state_type>;
+
+  public:
+    promise()
+      : state_(detail::make_shared_state<state_type>()),
+        future_retrieved_(false)
+    {}
+
+    promise(promise&& other) noexcept
+      : state_(std::move(other.state_)),
+        future_retrieved_(other.future_retrieved_)
+    {}
+
+    ~promise()
+    {
+      if(state_ && !state_->is_ready())
+      {
+        state_->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+      }
+    }
+
+    promise& operator=(promise&& other)
+    {
+      promise(std::move(other)).swap(*this);
+      return *this;
+    }
+
+    void swap(promise& other)
+    {
+      std::swap(state_, other.state_);
+      std::swap(future_retrieved_, other.future_retrieved_);
+    }
+
+    future<T> get_future()
+    {
+      check_state();
+
+      if(future_retrieved_)
+      {
+        throw std::future_error(std::future_errc::future_already_retrieved);
+      }
+
+      future_retrieved_ = true;
+
+      return future<T>(state_ptr_type(state_));
+    }
+
+    template<class... Args>
+    void set_value(Args&&... args)
+    {
+      check_unsatisfied();
+      state_->set_value(std::forward<Args>(args)...);
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+      check_unsatisfied();
+      state_->set_exception(e);
+    }
+
+  private:
+    void check_state() const
+    {
+      if(!state_)
+      {
+        throw std::future_error(std::future_errc::no_state);
+      }
+    }
+
+    void check_unsatisfied() const
+    {
+      check_state();
+
+      if(state_->is_ready())
+      {
+        throw std::future_error(std::future_errc::promise_already_satisfied);
+      }
+    }
+
+    state_ptr_type state_;
+    bool future_retrieved_;
+};
+
+
+} // end agency
+
@@ -97,9 +97,10 @@ class arena_resource
     __AGENCY_ANNOTATION
     bool owns(void* ptr, std::size_t) const noexcept
     {
-      int index_of_ptr = reinterpret_cast<char*>(ptr) - buf_;
+      // use a ptrdiff_t because the difference may not fit in an int when ptr was allocated by a different resource
+      std::ptrdiff_t index_of_ptr = reinterpret_cast<char*>(ptr) - buf_;
 
-      return index_of_ptr >= 0 && index_of_first_free_byte_ >= static_cast<unsigned int>(index_of_ptr);
+      return index_of_ptr >= 0 && index_of_first_free_byte_ >= static_cast<std::size_t>(index_of_ptr);
     }
 
   private:
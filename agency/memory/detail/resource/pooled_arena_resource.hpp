@@ -0,0 +1,244 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// arena_buffer_pool retains the buffers of destroyed pooled_arena_resources for reuse
+// buffer sizes are rounded up to a power of two, and the pool retains a few buffers of each size
+class arena_buffer_pool
+{
+  public:
+    static constexpr std::size_t min_buffer_size = 1024;
+    static constexpr std::size_t num_size_classes = 32;
+    static constexpr std::size_t max_num_retained_buffers_per_size_class = 16;
+
+    arena_buffer_pool()
+      : num_retained_buffers_()
+    {}
+
+    arena_buffer_pool(const arena_buffer_pool&) = delete;
+    arena_buffer_pool& operator=(const arena_buffer_pool&) = delete;
+
+    ~arena_buffer_pool()
+    {
+      for(std::size_t i = 0; i < num_size_classes; ++i)
+      {
+        for(std::size_t j = 0; j < num_retained_buffers_[i]; ++j)
+        {
+          std::free(retained_buffers_[i][j]);
+        }
+      }
+    }
+
+    // returns the size of the buffer which acquire(n) returns
+    static std::size_t buffer_size(std::size_t n)
+    {
+      std::size_t which = size_class(n);
+      return which < num_size_classes ? min_buffer_size << which : n;
+    }
+
+    // returns a buffer of buffer_size(n) bytes, or nullptr if no such buffer could be allocated
+    void* acquire(std::size_t n)
+    {
+      std::size_t which = size_class(n);
+
+      if(which < num_size_classes)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(num_retained_buffers_[which] > 0)
+        {
+          return retained_buffers_[which][--num_retained_buffers_[which]];
+        }
+      }
+
+      return std::malloc(buffer_size(n));
+    }
+
+    // returns a buffer previously returned by acquire(n) to the pool
+    void release(void* buffer, std::size_t n)
+    {
+      std::size_t which = size_class(n);
+
+      if(which < num_size_classes)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(num_retained_buffers_[which] < max_num_retained_buffers_per_size_class)
+        {
+          retained_buffers_[which][num_retained_buffers_[which]++] = buffer;
+          return;
+        }
+      }
+
+      std::free(buffer);
+    }
+
+  private:
+    // returns num_size_classes when n is too large for the pool to retain
+    static std::size_t size_class(std::size_t n)
+    {
+      std::size_t result = 0;
+      while(result < num_size_classes && (min_buffer_size << result) < n)
+      {
+        ++result;
+      }
+
+      return result;
+    }
+
+    std::mutex mutex_;
+    std::size_t num_retained_buffers_[num_size_classes];
+    void* retained_buffers_[num_size_classes][max_num_retained_buffers_per_size_class];
+};
+
+
+// the system's pool is never destroyed, because the threads of the system's thread pools may release buffers to it
+// while the program's static objects are destroyed
+inline arena_buffer_pool& system_arena_buffer_pool()
+{
+  static arena_buffer_pool* resource = new arena_buffer_pool;
+  return *resource;
+}
+
+
+// pooled_arena_resource is a C++ "memory resource" which
+// allocates memory from a buffer whose size is chosen at runtime
+// like arena_resource, it returns nullptr when the buffer is exhausted and
+// reclaims storage only when the most recent allocation is deallocated
+// the buffer is acquired from system_arena_buffer_pool() upon the first allocation and released to it upon destruction,
+// so that consecutive pooled_arena_resources of similar size reuse the same buffers rather than allocate new ones,
+// and a pooled_arena_resource which never allocates never visits the pool
+//
+// a default-constructed pooled_arena_resource, and any pooled_arena_resource constructed in device code, has no buffer
+class pooled_arena_resource
+{
+  public:
+    static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+    __AGENCY_ANNOTATION
+    pooled_arena_resource() noexcept
+      : buf_(nullptr),
+        size_(0),
+        index_of_first_free_byte_(0)
+    {}
+
+    __AGENCY_ANNOTATION
+    explicit pooled_arena_resource(std::size_t size) noexcept
+      : pooled_arena_resource()
+    {
+#ifndef __CUDA_ARCH__
+      if(size > 0)
+      {
+        size_ = arena_buffer_pool::buffer_size(size);
+      }
+#endif
+    }
+
+    __AGENCY_ANNOTATION
+    pooled_arena_resource(const pooled_arena_resource&) = delete;
+
+    __AGENCY_ANNOTATION
+    pooled_arena_resource& operator=(const pooled_arena_resource&) = delete;
+
+    __AGENCY_ANNOTATION
+    ~pooled_arena_resource()
+    {
+#ifndef __CUDA_ARCH__
+      if(buf_)
+      {
+        system_arena_buffer_pool().release(buf_, size_);
+      }
+#endif
+    }
+
+    __AGENCY_ANNOTATION
+    void* allocate(std::size_t n)
+    {
+      std::size_t aligned_n = align_up(n);
+      if(aligned_n > num_remaining_bytes())
+      {
+        return nullptr;
+      }
+
+#ifndef __CUDA_ARCH__
+      if(!buf_)
+      {
+        buf_ = reinterpret_cast<char*>(system_arena_buffer_pool().acquire(size_));
+        if(!buf_)
+        {
+          size_ = 0;
+          return nullptr;
+        }
+      }
+#endif
+
+      char* r = buf_ + index_of_first_free_byte_;
+      index_of_first_free_byte_ += aligned_n;
+      return r;
+    }
+
+    __AGENCY_ANNOTATION
+    void deallocate(void* p_, std::size_t n) noexcept
+    {
+      std::size_t index_of_p = reinterpret_cast<char*>(p_) - buf_;
+      std::size_t aligned_n = align_up(n);
+
+      if(index_of_p + aligned_n == index_of_first_free_byte_)
+      {
+        index_of_first_free_byte_ = index_of_p;
+      }
+    }
+
+    __AGENCY_ANNOTATION
+    std::size_t size() const noexcept
+    {
+      return size_;
+    }
+
+    __AGENCY_ANNOTATION
+    void reset() noexcept
+    {
+      index_of_first_free_byte_ = 0;
+    }
+
+    __AGENCY_ANNOTATION
+    bool owns(void* ptr, std::size_t) const noexcept
+    {
+      std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+      std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(buf_);
+
+      return buf_ && begin <= address && address <= begin + index_of_first_free_byte_;
+    }
+
+  private:
+    __AGENCY_ANNOTATION
+    static std::size_t align_up(std::size_t n) noexcept
+    {
+      return (n + (alignment-1)) & ~(alignment-1);
+    }
+
+    __AGENCY_ANNOTATION
+    std::size_t num_remaining_bytes() const noexcept
+    {
+      return size_ - index_of_first_free_byte_;
+    }
+
+    char* buf_;
+    std::size_t size_;
+    std::size_t index_of_first_free_byte_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <cstddef>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// thread_local_cached_resource caches small deallocated blocks in per-thread free lists
+// so that the allocation and deallocation of short-lived, fixed-size objects (e.g., the
+// shared states of futures) usually avoids the base resource entirely
+//
+// Blocks are grouped into size classes of block_granularity bytes. Requests larger than
+// the largest size class pass through to the base resource. A block deallocated by a
+// different thread than the one which allocated it simply joins the deallocating thread's cache.
+//
+// The caches of all thread_local_cached_resource<MemoryResource> objects of the same type are
+// shared, so MemoryResource must be stateless
+template<class MemoryResource = malloc_resource>
+class thread_local_cached_resource : private MemoryResource
+{
+  public:
+    static constexpr std::size_t block_granularity = 16;
+    static constexpr std::size_t num_size_classes = 16;
+    static constexpr std::size_t max_cached_blocks_per_size_class = 64;
+
+    using resource_type = MemoryResource;
+
+    thread_local_cached_resource() = default;
+
+    inline void* allocate(std::size_t num_bytes)
+    {
+      std::size_t size_class = size_class_of(num_bytes);
+
+      if(size_class < num_size_classes)
+      {
+        free_lists* cache = this_threads_cache();
+
+        if(cache && cache->heads[size_class])
+        {
+          free_block* result = cache->heads[size_class];
+          cache->heads[size_class] = result->next;
+          --cache->counts[size_class];
+          return result;
+        }
+
+        // allocate the entire size class so that the block may be cached later
+        return resource_type::allocate(bytes_of(size_class));
+      }
+
+      return resource_type::allocate(num_bytes);
+    }
+
+    inline void deallocate(void* ptr, std::size_t num_bytes)
+    {
+      std::size_t size_class = size_class_of(num_bytes);
+
+      if(size_class < num_size_classes)
+      {
+        free_lists* cache = this_threads_cache();
+
+        if(cache && cache->counts[size_class] < max_cached_blocks_per_size_class)
+        {
+          free_block* block = reinterpret_cast<free_block*>(ptr);
+          block->next = cache->heads[size_class];
+          cache->heads[size_class] = block;
+          ++cache->counts[size_class];
+          return;
+        }
+
+        resource_type::deallocate(ptr, bytes_of(size_class));
+        return;
+      }
+
+      resource_type::deallocate(ptr, num_bytes);
+    }
+
+    inline bool is_equal(const thread_local_cached_resource&) const
+    {
+      return true;
+    }
+
+    inline bool operator==(const thread_local_cached_resource& other) const
+    {
+      return is_equal(other);
+    }
+
+    inline bool operator!=(const thread_local_cached_resource& other) const
+    {
+      return !is_equal(other);
+    }
+
+  private:
+    struct free_block
+    {
+      free_block* next;
+    };
+
+    struct free_lists : private MemoryResource
+    {
+      free_block* heads[num_size_classes];
+      std::size_t counts[num_size_classes];
+
+      free_lists()
+      {
+        for(std::size_t i = 0; i < num_size_classes; ++i)
+        {
+          heads[i] = nullptr;
+          counts[i] = 0;
+        }
+      }
+
+      // return cached blocks to the base resource when the thread exits
+      ~free_lists()
+      {
+        for(std::size_t i = 0; i < num_size_classes; ++i)
+        {
+          while(heads[i])
+          {
+            free_block* block = heads[i];
+            heads[i] = block->next;
+            MemoryResource::deallocate(block, bytes_of(i));
+          }
+        }
+
+        is_destroyed() = true;
+      }
+    };
+
+    static std::size_t size_class_of(std::size_t num_bytes)
+    {
+      return num_bytes == 0 ? 0 : (num_bytes - 1) / block_granularity;
+    }
+
+    static std::size_t bytes_of(std::size_t size_class)
+    {
+      return (size_class + 1) * block_granularity;
+    }
+
+    // this flag is trivially destructible, so it remains usable after this thread's
+    // free_lists has been destroyed during thread exit
+    static bool& is_destroyed()
+    {
+      static thread_local bool result = false;
+      return result;
+    }
+
+    // returns nullptr if this thread's cache has already been destroyed
+    static free_lists* this_threads_cache()
+    {
+      if(is_destroyed()) return nullptr;
+
+      static thread_local free_lists cache;
+      return &cache;
+    }
+};
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,13 @@
+/// \file
+/// \brief Include this file to use any component of Agency related to the machine's topology.
+///
+/// Including `<agency/topology.hpp>` recursively includes Agency header files organized beneath
+/// `<agency/topology/*>`.
+///
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/topology/system_topology.hpp>
+#include <agency/topology/topology_executor.hpp>
+
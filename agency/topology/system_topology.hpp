@@ -0,0 +1,363 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/thread_placement.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace agency
+{
+
+
+// topology describes the processors of a machine
+//
+// A machine contains sockets. Each socket contains cores, and each core contains
+// one or more cpus, which are its SMT siblings (hardware threads). cpus are named by the
+// operating system's processor numbers. Independently, cpus are grouped into NUMA nodes,
+// which are numbered like detail::numa_topology.
+//
+// Only the cpus on which the process may run are described.
+class topology
+{
+  public:
+    struct cache
+    {
+      // 1 for L1, 2 for L2, etc.
+      size_t level;
+
+      // "Data", "Instruction", or "Unified"
+      std::string type;
+
+      size_t size;
+      size_t line_size;
+
+      // the cpus which share this cache
+      std::vector<int> cpus;
+    };
+
+    struct core
+    {
+      size_t socket;
+      size_t numa_node;
+
+      // the SMT siblings of this core
+      std::vector<int> cpus;
+    };
+
+    struct socket
+    {
+      // indices into cores()
+      std::vector<size_t> cores;
+    };
+
+    struct numa_node
+    {
+      std::vector<int> cpus;
+
+      // indices into cores()
+      std::vector<size_t> cores;
+    };
+
+    topology(std::vector<socket> sockets,
+             std::vector<numa_node> numa_nodes,
+             std::vector<core> cores,
+             std::vector<cache> caches,
+             std::string model_name = std::string())
+      : sockets_(std::move(sockets)),
+        numa_nodes_(std::move(numa_nodes)),
+        cores_(std::move(cores)),
+        caches_(std::move(caches)),
+        model_name_(std::move(model_name))
+    {}
+
+    const std::vector<socket>& sockets() const
+    {
+      return sockets_;
+    }
+
+    const std::vector<numa_node>& numa_nodes() const
+    {
+      return numa_nodes_;
+    }
+
+    const std::vector<core>& cores() const
+    {
+      return cores_;
+    }
+
+    // each distinct cache appears once, ordered by level
+    const std::vector<cache>& caches() const
+    {
+      return caches_;
+    }
+
+    const std::string& model_name() const
+    {
+      return model_name_;
+    }
+
+    size_t num_cpus() const
+    {
+      size_t result = 0;
+      for(const auto& c : cores_)
+      {
+        result += c.cpus.size();
+      }
+
+      return result;
+    }
+
+    // returns the size in bytes of the data cache at the given level which is private to the fewest cpus,
+    // or 0 if there is no such cache
+    size_t cache_size(size_t level) const
+    {
+      const cache* c = find_data_cache(level);
+      return c ? c->size : 0;
+    }
+
+    // returns the line size of the level 1 data cache, or 64 if it is unknown
+    size_t cache_line_size() const
+    {
+      const cache* c = find_data_cache(1);
+      return c && c->line_size ? c->line_size : 64;
+    }
+
+  private:
+    const cache* find_data_cache(size_t level) const
+    {
+      const cache* result = nullptr;
+
+      for(const auto& c : caches_)
+      {
+        if(c.level == level && c.type != "Instruction")
+        {
+          if(!result || c.cpus.size() < result->cpus.size())
+          {
+            result = &c;
+          }
+        }
+      }
+
+      return result;
+    }
+
+    std::vector<socket> sockets_;
+    std::vector<numa_node> numa_nodes_;
+    std::vector<core> cores_;
+    std::vector<cache> caches_;
+    std::string model_name_;
+};
+
+
+namespace detail
+{
+namespace topology_detail
+{
+
+
+// returns the first line of the given file, or the empty string if it cannot be read
+inline std::string read_first_line(const std::string& path)
+{
+  std::ifstream file(path);
+
+  std::string result;
+  std::getline(file, result);
+
+  return result;
+}
+
+
+// parses sizes such as "32K" or "8M"
+inline size_t parse_size(const std::string& str)
+{
+  char* suffix = nullptr;
+  size_t result = std::strtoul(str.c_str(), &suffix, 10);
+
+  if(suffix)
+  {
+    if(*suffix == 'K') result *= 1024;
+    else if(*suffix == 'M') result *= 1024 * 1024;
+    else if(*suffix == 'G') result *= 1024 * 1024 * 1024;
+  }
+
+  return result;
+}
+
+
+// the fields of /proc/cpuinfo used to describe a cpu when /sys/devices/system/cpu is unavailable
+struct cpuinfo
+{
+  std::string model_name;
+
+  // maps each cpu to its (physical id, core id)
+  std::map<int, std::pair<int,int>> locations;
+};
+
+
+inline cpuinfo read_cpuinfo()
+{
+  cpuinfo result;
+
+  std::ifstream file("/proc/cpuinfo");
+
+  int cpu = -1;
+  std::string line;
+  while(std::getline(file, line))
+  {
+    size_t colon = line.find(':');
+    if(colon == std::string::npos) continue;
+
+    std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+    std::string value = colon + 2 <= line.size() ? line.substr(colon + 2) : std::string();
+
+    if(key == "processor")
+    {
+      cpu = std::atoi(value.c_str());
+      result.locations[cpu] = std::make_pair(0, cpu);
+    }
+    else if(key == "model name" && result.model_name.empty())
+    {
+      result.model_name = value;
+    }
+    else if(key == "physical id" && cpu >= 0)
+    {
+      result.locations[cpu].first = std::atoi(value.c_str());
+    }
+    else if(key == "core id" && cpu >= 0)
+    {
+      result.locations[cpu].second = std::atoi(value.c_str());
+    }
+  }
+
+  return result;
+}
+
+
+inline topology read_system_topology()
+{
+  const std::string cpu_path = "/sys/devices/system/cpu/cpu";
+
+  const numa_topology& numa = numa_topology::system();
+  cpuinfo info = read_cpuinfo();
+
+  std::vector<int> cpus;
+  for(size_t node = 0; node < numa.num_nodes(); ++node)
+  {
+    cpus.insert(cpus.end(), numa.cpus(node).begin(), numa.cpus(node).end());
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+
+  // group cpus into cores by their (socket, core) location
+  std::map<std::pair<int,int>, std::vector<int>> cpus_of_location;
+
+  for(int cpu : cpus)
+  {
+    std::string dir = cpu_path + std::to_string(cpu) + "/topology/";
+    std::string package_id = read_first_line(dir + "physical_package_id");
+    std::string core_id = read_first_line(dir + "core_id");
+
+    std::pair<int,int> location(0, cpu);
+
+    if(!package_id.empty() && !core_id.empty())
+    {
+      location = std::make_pair(std::atoi(package_id.c_str()), std::atoi(core_id.c_str()));
+    }
+    else if(info.locations.count(cpu))
+    {
+      location = info.locations[cpu];
+    }
+
+    cpus_of_location[location].push_back(cpu);
+  }
+
+  // number sockets consecutively in the order of their physical ids
+  std::map<int, size_t> socket_index;
+  for(const auto& location : cpus_of_location)
+  {
+    socket_index.insert(std::make_pair(location.first.first, socket_index.size()));
+  }
+
+  std::vector<topology::socket> sockets(socket_index.size());
+  std::vector<topology::numa_node> numa_nodes(numa.num_nodes());
+  std::vector<topology::core> cores;
+
+  for(size_t node = 0; node < numa.num_nodes(); ++node)
+  {
+    numa_nodes[node].cpus = numa.cpus(node);
+  }
+
+  for(const auto& location : cpus_of_location)
+  {
+    topology::core c;
+    c.socket = socket_index[location.first.first];
+    c.numa_node = numa.node_of(location.second.front());
+    c.cpus = location.second;
+
+    sockets[c.socket].cores.push_back(cores.size());
+
+    if(c.numa_node < numa_nodes.size())
+    {
+      numa_nodes[c.numa_node].cores.push_back(cores.size());
+    }
+
+    cores.push_back(std::move(c));
+  }
+
+  // collect each distinct cache
+  std::map<std::tuple<size_t,std::string,std::vector<int>>, topology::cache> distinct_caches;
+
+  for(int cpu : cpus)
+  {
+    for(int index = 0; ; ++index)
+    {
+      std::string dir = cpu_path + std::to_string(cpu) + "/cache/index" + std::to_string(index) + "/";
+      std::string level = read_first_line(dir + "level");
+
+      if(level.empty()) break;
+
+      topology::cache c;
+      c.level = std::atoi(level.c_str());
+      c.type = read_first_line(dir + "type");
+      c.size = parse_size(read_first_line(dir + "size"));
+      c.line_size = std::atoi(read_first_line(dir + "coherency_line_size").c_str());
+      c.cpus = thread_placement_detail::parse_cpu_list(read_first_line(dir + "shared_cpu_list"));
+
+      auto key = std::make_tuple(c.level, c.type, c.cpus);
+      distinct_caches.insert(std::make_pair(key, std::move(c)));
+    }
+  }
+
+  std::vector<topology::cache> caches;
+  for(auto& c : distinct_caches)
+  {
+    caches.push_back(std::move(c.second));
+  }
+
+  return topology(std::move(sockets), std::move(numa_nodes), std::move(cores), std::move(caches), info.model_name);
+}
+
+
+} // end topology_detail
+} // end detail
+
+
+// returns the topology of this machine, read from /sys/devices/system and /proc/cpuinfo
+// the topology is read once, upon the first call to system_topology()
+inline const topology& system_topology()
+{
+  static topology result = detail::topology_detail::read_system_topology();
+  return result;
+}
+
+
+} // end agency
+
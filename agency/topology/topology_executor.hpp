@@ -0,0 +1,86 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/topology/system_topology.hpp>
+#include <agency/detail/concurrency/thread_placement.hpp>
+// XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/execution/executor/executor_array.hpp>
+#include <agency/execution/executor/concurrent_executor.hpp>
+#include <agency/execution/executor/customization_points.hpp>
+
+#include <memory>
+#include <vector>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// returns a thread pool whose workers are confined to the given NUMA node of the system_topology()
+// the pool has one worker per core of the node
+inline thread_pool& numa_node_thread_pool(size_t node)
+{
+  static std::vector<std::unique_ptr<thread_pool>> pools = []
+  {
+    std::vector<std::unique_ptr<thread_pool>> result;
+
+    for(size_t i = 0; i < system_topology().numa_nodes().size(); ++i)
+    {
+      size_t num_cores = std::max<size_t>(1, system_topology().numa_nodes()[i].cores.size());
+
+      result.emplace_back(new thread_pool(num_cores, thread_pool_mode::work_stealing, placement_policy::numa_node(i)));
+    }
+
+    return result;
+  }();
+
+  return *pools.at(node);
+}
+
+
+} // end detail
+
+
+// topology_executor's outer level spans NUMA nodes and its inner level spans the cores of each node
+//
+// Its shape is (outer, inner). Outer index i executes on the cores of node i % number of nodes.
+// The outer agents execute concurrently, so that every node works at once.
+class topology_executor : public executor_array<detail::thread_pool_executor, concurrent_executor>
+{
+  private:
+    using super_t = executor_array<detail::thread_pool_executor, concurrent_executor>;
+
+  public:
+    using super_t::super_t;
+
+    // one outer agent per node and one inner agent per core of node 0
+    shape_type unit_shape() const
+    {
+      return make_shape(size(), agency::unit_shape(inner_executor(0)));
+    }
+};
+
+
+// returns a topology_executor for the system_topology()
+//
+// Each node's agents execute on a pool of threads confined to that node, so data first touched
+// by the agents of one outer index stays within that index's node. The executor's unit_shape()
+// is (number of nodes, number of cores of node 0).
+inline topology_executor make_topology_executor()
+{
+  std::vector<detail::thread_pool_executor> node_executors;
+
+  for(size_t node = 0; node < system_topology().numa_nodes().size(); ++node)
+  {
+    node_executors.emplace_back(detail::numa_node_thread_pool(node));
+  }
+
+  return topology_executor(node_executors.begin(), node_executors.end());
+}
+
+
+} // end agency
+
@@ -0,0 +1,80 @@
+#include <agency/detail/concurrency/barrier.hpp>
+#include <agency/detail/concurrency/arrive_and_wait.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// this program measures the mean duration of a phase of the barriers which concurrent agents may use
+// during each phase, each of a group of threads arrives at the barrier and waits for the others
+//
+// spinning_barrier is measured only for groups no larger than the number of hardware threads,
+// because its waiting threads never yield their processors
+//
+// usage: barrier_latency [num_phases]
+
+template<class Barrier>
+double microseconds_per_phase(size_t num_threads, size_t num_phases)
+{
+  Barrier barrier(num_threads);
+
+  auto thread_body = [&](size_t index)
+  {
+    for(size_t phase = 0; phase < num_phases; ++phase)
+    {
+      agency::detail::arrive_and_wait(barrier, index);
+    }
+  };
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> threads;
+  for(size_t i = 1; i < num_threads; ++i)
+  {
+    threads.emplace_back(thread_body, i);
+  }
+
+  thread_body(0);
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_phases;
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_phases = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+  size_t num_hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << "threads, blocking_barrier (us/phase), spinning_barrier (us/phase), tree_barrier (us/phase)" << std::endl;
+
+  for(size_t num_threads : {2, 4, 8, 16, 32, 64})
+  {
+    std::cout << num_threads << ", "
+              << microseconds_per_phase<agency::detail::blocking_barrier>(num_threads, num_phases) << ", ";
+
+    if(num_threads <= num_hardware_threads)
+    {
+      std::cout << microseconds_per_phase<agency::detail::spinning_barrier>(num_threads, num_phases) << ", ";
+    }
+    else
+    {
+      std::cout << "-, ";
+    }
+
+    std::cout << microseconds_per_phase<agency::detail::tree_barrier>(num_threads, num_phases) << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,50 @@
+#include <agency/agency.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// this program measures the latency of launching groups of concurrent agents
+// which synchronize once through a barrier
+//
+// usage: concurrent_launch_latency [num_trials]
+
+double mean_launch_latency_in_microseconds(size_t num_agents, size_t num_trials)
+{
+  auto launch = [=]
+  {
+    agency::bulk_invoke(agency::con(num_agents), [](agency::concurrent_agent& self)
+    {
+      self.wait();
+    });
+  };
+
+  // warm up
+  launch();
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(size_t i = 0; i < num_trials; ++i)
+  {
+    launch();
+  }
+
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_trials;
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_trials = argc > 1 ? std::atoi(argv[1]) : 20;
+
+  std::cout << "num_agents, mean launch latency (us)" << std::endl;
+
+  for(size_t num_agents : {1, 4, 16, 64, 256})
+  {
+    std::cout << num_agents << ", " << mean_launch_latency_in_microseconds(num_agents, num_trials) << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
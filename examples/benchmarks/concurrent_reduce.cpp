@@ -0,0 +1,98 @@
+#include <agency/agency.hpp>
+#include <agency/execution/executor/experimental/fiber_executor.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// this program measures the mean duration of a sum of one value per agent within groups of various sizes
+// it compares concurrent_agent::all_reduce() with a hand-written tree reduction through a shared_vector,
+// which pays for one barrier per level of the tree
+// groups larger than the machine's number of threads execute on fibers, so that the program measures
+// how the cost of the collectives scales with the size of the group rather than with oversubscription
+//
+// usage: concurrent_reduce [num_reductions]
+
+int tree_reduction(agency::concurrent_agent& self, int value)
+{
+  agency::shared_vector<int> scratch(self, self.group_size(), 0);
+
+  auto i = self.rank();
+  auto n = scratch.size();
+
+  scratch[i] = value;
+  self.wait();
+
+  while(n > 1)
+  {
+    if(i < n/2)
+    {
+      scratch[i] += scratch[n - i - 1];
+    }
+
+    self.wait();
+
+    n -= n/2;
+  }
+
+  return scratch[0];
+}
+
+template<class Reduction>
+double microseconds_per_reduction(agency::experimental::fiber_executor& fibers, size_t group_size, size_t num_reductions, Reduction reduction)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  auto policy = agency::con(group_size);
+
+  auto body = [=](agency::concurrent_agent& self)
+  {
+    for(size_t i = 0; i < num_reductions; ++i)
+    {
+      if(reduction(self, 1) != static_cast<int>(group_size))
+      {
+        std::cerr << "error" << std::endl;
+        std::abort();
+      }
+    }
+  };
+
+  if(group_size <= std::thread::hardware_concurrency())
+  {
+    agency::bulk_invoke(policy, body);
+  }
+  else
+  {
+    agency::bulk_invoke(policy.on(fibers), body);
+  }
+
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_reductions;
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_reductions = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  agency::experimental::fiber_executor fibers;
+
+  std::cout << "group size, all_reduce (us/reduction), tree of shared_vector (us/reduction)" << std::endl;
+
+  for(size_t group_size : {2, 4, 8, 16, 64, 256, 1024, 4096})
+  {
+    std::cout << group_size << ", "
+              << microseconds_per_reduction(fibers, group_size, num_reductions, [](agency::concurrent_agent& self, int value)
+                 {
+                   return self.all_reduce(value, std::plus<int>());
+                 }) << ", "
+              << microseconds_per_reduction(fibers, group_size, num_reductions, tree_reduction) << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,53 @@
+#include <agency/agency.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// this program measures the mean duration of the creation and destruction of a vector shared by a group of concurrent agents
+// it compares groups whose vectors are allocated by malloc with groups which reserve memory for them with memory_size()
+//
+// usage: group_memory [num_vectors] [group_size]
+
+template<class ExecutionPolicy>
+double microseconds_per_vector(ExecutionPolicy policy, size_t num_elements, size_t num_vectors)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  agency::bulk_invoke(policy, [=](agency::concurrent_agent& self)
+  {
+    for(size_t i = 0; i < num_vectors; ++i)
+    {
+      agency::shared_vector<int> scratch(self, num_elements, 0);
+
+      scratch[self.rank()] = 1;
+
+      self.wait();
+    }
+  });
+
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_vectors;
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_vectors = argc > 1 ? std::atoi(argv[1]) : 2000;
+  size_t group_size = argc > 2 ? std::atoi(argv[2]) : 4;
+
+  std::cout << "vector size (bytes), malloc (us/vector), memory_size() (us/vector)" << std::endl;
+
+  for(size_t num_elements : {64, 1024, 16 * 1024, 256 * 1024})
+  {
+    size_t num_bytes = num_elements * sizeof(int);
+
+    std::cout << num_bytes << ", "
+              << microseconds_per_vector(agency::con(group_size), num_elements, num_vectors) << ", "
+              << microseconds_per_vector(agency::con(group_size).memory_size(num_bytes), num_elements, num_vectors) << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,70 @@
+#include <agency/agency.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// this program measures the latency between a call to bulk_invoke(par(8), ...) and the start of its first agent
+// the launches are measured while the system thread pool's idle workers sleep and while they spin
+//
+// usage: launch_latency [num_trials] [num_spinning_workers]
+
+double launch_to_first_agent_latency_in_microseconds()
+{
+  using clock = std::chrono::steady_clock;
+
+  std::atomic<bool> started(false);
+  clock::time_point first_agent_start;
+
+  auto start = clock::now();
+
+  agency::bulk_invoke(agency::par(8), [&](agency::parallel_agent&)
+  {
+    if(!started.exchange(true))
+    {
+      first_agent_start = clock::now();
+    }
+  });
+
+  std::chrono::duration<double, std::micro> elapsed = first_agent_start - start;
+
+  return elapsed.count();
+}
+
+double median_latency_in_microseconds(size_t num_trials)
+{
+  // warm up
+  launch_to_first_agent_latency_in_microseconds();
+
+  std::vector<double> samples;
+  for(size_t i = 0; i < num_trials; ++i)
+  {
+    samples.push_back(launch_to_first_agent_latency_in_microseconds());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_trials = argc > 1 ? std::atoi(argv[1]) : 1001;
+  size_t num_spinning_workers = argc > 2 ? std::atoi(argv[2]) : 1;
+
+  agency::detail::thread_pool& pool = agency::detail::system_thread_pool();
+
+  std::cout << "idle workers, median launch-to-first-agent latency (us)" << std::endl;
+
+  pool.set_spinning(agency::detail::thread_pool_spinning());
+  std::cout << "sleeping, " << median_latency_in_microseconds(num_trials) << std::endl;
+
+  pool.set_spinning(agency::detail::thread_pool_spinning(num_spinning_workers, std::chrono::microseconds(200)));
+  std::cout << "spinning, " << median_latency_in_microseconds(num_trials) << std::endl;
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,69 @@
+#include <agency/agency.hpp>
+#include <agency/experimental/parallel_region.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// this program compares the cost of an iteration of a solver loop which launches
+// bulk_invoke(par(n), ...) each iteration with one which executes inside a single parallel region
+//
+// usage: parallel_region_iteration [num_iterations]
+
+template<class Function>
+double mean_iteration_time_in_microseconds(size_t num_iterations, Function loop)
+{
+  // warm up
+  loop(1);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  loop(num_iterations);
+
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_iterations;
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_iterations = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  std::cout << "n, bulk_invoke (us), parallel_region (us)" << std::endl;
+
+  for(size_t n : {1 << 10, 1 << 14, 1 << 18})
+  {
+    std::vector<float> x(n, 1), y(n, 0);
+
+    double bulk_invoke_time = mean_iteration_time_in_microseconds(num_iterations, [&](size_t num_iterations)
+    {
+      for(size_t iter = 0; iter < num_iterations; ++iter)
+      {
+        agency::bulk_invoke(agency::par(n), [&](agency::parallel_agent& self)
+        {
+          y[self.index()] += 0.5f * x[self.index()];
+        });
+      }
+    });
+
+    double parallel_region_time = mean_iteration_time_in_microseconds(num_iterations, [&](size_t num_iterations)
+    {
+      agency::experimental::parallel_region([&](agency::experimental::parallel_team& team)
+      {
+        for(size_t iter = 0; iter < num_iterations; ++iter)
+        {
+          team.for_each(n, [&](size_t i)
+          {
+            y[i] += 0.5f * x[i];
+          });
+        }
+      });
+    });
+
+    std::cout << n << ", " << bulk_invoke_time << ", " << parallel_region_time << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
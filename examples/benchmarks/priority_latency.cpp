@@ -0,0 +1,66 @@
+#include <agency/agency.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// this program measures the latency of small tasks submitted to the system thread pool
+// while a large bulk_async occupies every worker
+// each task is submitted with normal priority and with high priority
+//
+// usage: priority_latency [num_agents]
+
+double latency_in_microseconds(agency::detail::thread_pool_executor exec, std::vector<double>& data)
+{
+  // start a long batch job
+  auto batch = agency::bulk_async(agency::par(data.size()), [&](agency::parallel_agent& self)
+  {
+    data[self.index()] = data[self.index()] * 2 + 1;
+  });
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // submit a small task behind it and wait for the result
+  agency::async(exec, []{ return 0; }).wait();
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  batch.wait();
+
+  return elapsed.count() * 1e6;
+}
+
+double median_latency_in_microseconds(agency::detail::thread_pool_executor exec, std::vector<double>& data)
+{
+  std::vector<double> samples;
+  for(int i = 0; i < 21; ++i)
+  {
+    samples.push_back(latency_in_microseconds(exec, data));
+  }
+
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_agents = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+  agency::detail::thread_pool_executor exec;
+
+  // initialize the data once, outside of the measurements
+  std::vector<double> data(num_agents, 1);
+
+  std::cout << "num_agents, normal priority latency (us), high priority latency (us)" << std::endl;
+
+  std::cout << num_agents << ", "
+            << median_latency_in_microseconds(exec, data) << ", "
+            << median_latency_in_microseconds(exec.require(agency::priority.high), data)
+            << std::endl;
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include <agency/detail/concurrency/concurrent_queue.hpp>
+#include <agency/detail/concurrency/bounded_concurrent_queue.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// this program measures the throughput of the concurrent queues which thread_pool may use for its tasks
+// each of several producers submits tasks which each of several consumers pops and executes
+//
+// usage: queue_throughput [num_tasks_per_producer]
+
+template<class Queue>
+double millions_of_tasks_per_second(size_t num_producers, size_t num_consumers, size_t num_tasks_per_producer)
+{
+  Queue queue;
+
+  std::atomic<size_t> num_executed(0);
+  size_t num_tasks = num_producers * num_tasks_per_producer;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> consumers;
+  for(size_t i = 0; i < num_consumers; ++i)
+  {
+    consumers.emplace_back([&]
+    {
+      agency::detail::unique_function<void()> task;
+      while(queue.wait_and_pop(task))
+      {
+        task();
+      }
+    });
+  }
+
+  std::vector<std::thread> producers;
+  for(size_t i = 0; i < num_producers; ++i)
+  {
+    producers.emplace_back([&]
+    {
+      for(size_t j = 0; j < num_tasks_per_producer; ++j)
+      {
+        queue.emplace([&]{ ++num_executed; });
+      }
+    });
+  }
+
+  for(auto& t : producers) t.join();
+
+  while(num_executed.load() < num_tasks)
+  {
+    std::this_thread::yield();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  queue.close();
+  for(auto& t : consumers) t.join();
+
+  return num_tasks / elapsed.count() / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+  size_t num_tasks_per_producer = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+  using task = agency::detail::unique_function<void()>;
+
+  std::cout << "producers, consumers, atomic_wait (Mtasks/s), condition_variable (Mtasks/s), bounded (Mtasks/s)" << std::endl;
+
+  for(size_t num_threads : {1, 2, 4})
+  {
+    std::cout << num_threads << ", " << num_threads << ", "
+              << millions_of_tasks_per_second<agency::detail::atomic_wait_concurrent_queue<task>>(num_threads, num_threads, num_tasks_per_producer) << ", "
+              << millions_of_tasks_per_second<agency::detail::condition_variable_concurrent_queue<task>>(num_threads, num_threads, num_tasks_per_producer) << ", "
+              << millions_of_tasks_per_second<agency::detail::bounded_concurrent_queue<task>>(num_threads, num_threads, num_tasks_per_producer)
+              << std::endl;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <agency/agency.hpp>
+#include <functional>
 #include <vector>
 
 int sum(const std::vector<int>& data)
@@ -7,30 +8,13 @@ int sum(const std::vector<int>& data)
 
   return bulk_invoke(con(data.size()), [&](concurrent_agent& self) -> single_result<int>
   {
-    // copy data into scratch buffer
-    shared_vector<int> scratch(self, data);
+    // combine each agent's element with the group's other elements
+    auto result = self.reduce(data[self.index()], std::plus<int>());
 
-    auto i = self.index();
-    auto n = scratch.size();
-
-    while(n > 1)
-    {
-      if(i < n/2)
-      {
-        scratch[i] += scratch[n - i - 1];
-      }
-
-      // wait for every agent in the group to reach this point
-      self.wait();
-
-      // cut the number of active agents in half
-      n -= n/2;
-    }
-
-    // the first agent returns the result
-    if(i == 0)
+    // the first agent receives and returns the result
+    if(result)
     {
-      return scratch[0];
+      return *result;
     }
 
     // all other agents return an ignored value 
@@ -0,0 +1,245 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/execution/blocking_region.hpp>
+
+
+// a gate which blocks threads until it opens, without the knowledge of any thread pool
+class gate
+{
+  public:
+    gate() : is_open_(false) {}
+
+    void open()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_open_ = true;
+      cv_.notify_all();
+    }
+
+    void wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&]{ return is_open_; });
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool is_open_;
+};
+
+
+void test_blocking_region_outside_of_pool()
+{
+  // test that blocking_region has no effect outside of a pool
+  {
+    agency::this_thread::blocking_region region;
+  }
+
+  assert(agency::this_thread::blocking_invoke([]{ return 13; }) == 13);
+}
+
+
+void test_spare_workers()
+{
+  using namespace agency::detail;
+
+  thread_pool pool(2);
+
+  // block every worker on a gate which only a later task opens
+  // without spare workers, the later task would never execute
+  gate g;
+  std::atomic<int> num_blocked(0);
+
+  std::vector<std::future<void>> blocked;
+  for(int i = 0; i < 2; ++i)
+  {
+    blocked.push_back(pool.async([&]
+    {
+      agency::this_thread::blocking_region region;
+
+      // a nested region does not count twice
+      agency::this_thread::blocking_region nested_region;
+
+      ++num_blocked;
+      g.wait();
+    }));
+  }
+
+  while(num_blocked.load() < 2)
+  {
+    std::this_thread::yield();
+  }
+
+  assert(pool.num_blocked_threads() == 2);
+
+  std::future<int> opener = pool.async([&]
+  {
+    g.open();
+    return 7;
+  });
+
+  assert(opener.get() == 7);
+
+  for(auto& f : blocked)
+  {
+    f.get();
+  }
+
+  assert(pool.num_blocked_threads() == 0);
+
+  // test that the spare workers exit once they are no longer needed
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while(pool.num_running_threads() > pool.size() && std::chrono::steady_clock::now() < deadline)
+  {
+    // wake the workers so that the spares notice they are unneeded
+    pool.async([]{}).wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  assert(pool.num_running_threads() <= pool.size());
+
+  // test that the pool still works
+  std::atomic<int> sum(0);
+  std::vector<std::future<void>> futures;
+  for(int i = 0; i < 10; ++i)
+  {
+    futures.push_back(pool.async([&sum, i]{ sum += i; }));
+  }
+
+  for(auto& f : futures)
+  {
+    f.get();
+  }
+
+  assert(sum == 45);
+}
+
+
+void test_blocking_inside_bulk_launch()
+{
+  using namespace agency::detail;
+
+  // the first agents block on a gate which only the final agent opens
+  // the launch's chunks not yet claimed when every worker blocks must be executed by spare workers
+  const size_t n = 4;
+
+  gate g;
+  std::atomic<size_t> num_executed(0);
+
+  std::promise<void> done;
+  std::future<void> done_future = done.get_future();
+
+  // the pool is destroyed first, so its workers are finished with the state above
+  thread_pool pool(2);
+
+  pool.bulk_submit([&](size_t idx)
+  {
+    if(idx < pool.size())
+    {
+      agency::this_thread::blocking_region region;
+      g.wait();
+    }
+    else if(idx == n - 1)
+    {
+      g.open();
+    }
+
+    if(++num_executed == n)
+    {
+      done.set_value();
+    }
+  },
+  n);
+
+  done_future.wait();
+
+  assert(num_executed == n);
+}
+
+
+void test_blocking_inside_foreign_bulk_launch()
+{
+  using namespace agency::detail;
+
+  // a worker of one pool which executes another pool's bulk launch and blocks inside it
+  // must not hand the launch's chunks to spare workers of its own pool
+  thread_pool outer(1);
+  thread_pool inner(2);
+
+  std::atomic<size_t> num_executed_by_outer_spares(0);
+
+  outer.async([&]
+  {
+    std::thread::id caller = std::this_thread::get_id();
+
+    inner.bulk_invoke([&](size_t idx)
+    {
+      if(this_worker::current_pool() == &outer && std::this_thread::get_id() != caller)
+      {
+        ++num_executed_by_outer_spares;
+      }
+
+      if(idx == 0)
+      {
+        agency::this_thread::blocking_region region;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      else
+      {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    },
+    100);
+  }).get();
+
+  assert(num_executed_by_outer_spares == 0);
+}
+
+
+void test_blocking_invoke()
+{
+  using namespace agency::detail;
+
+  thread_pool pool(1);
+
+  gate g;
+
+  std::future<int> blocked = pool.async([&]
+  {
+    return agency::this_thread::blocking_invoke([&]
+    {
+      g.wait();
+      return 42;
+    });
+  });
+
+  pool.async([&]{ g.open(); }).get();
+
+  assert(blocked.get() == 42);
+}
+
+
+int main()
+{
+  test_blocking_region_outside_of_pool();
+  test_spare_workers();
+  test_blocking_inside_bulk_launch();
+  test_blocking_inside_foreign_bulk_launch();
+  test_blocking_invoke();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,201 @@
+#include <agency/agency.hpp>
+#include <agency/shared.hpp>
+#include <agency/execution/executor/experimental/fiber_executor.hpp>
+#include <iostream>
+#include <cassert>
+#include <functional>
+
+
+struct maximum
+{
+  int operator()(int x, int y) const
+  {
+    return x < y ? y : x;
+  }
+};
+
+
+// a range of ranks [first, last], which is valid only if it was combined from adjacent ranges in rank order
+struct rank_range
+{
+  int first;
+  int last;
+  bool valid;
+};
+
+bool operator==(const rank_range& x, const rank_range& y)
+{
+  return x.first == y.first && x.last == y.last && x.valid == y.valid;
+}
+
+// joins adjacent ranges, so the result depends on the order of combination
+struct join_ranges
+{
+  rank_range operator()(const rank_range& x, const rank_range& y) const
+  {
+    return rank_range{x.first, y.last, x.valid && y.valid && x.last + 1 == y.first};
+  }
+};
+
+
+struct large_value
+{
+  double data[20];
+};
+
+struct add_first_elements
+{
+  large_value operator()(large_value x, const large_value& y) const
+  {
+    x.data[0] += y.data[0];
+    return x;
+  }
+};
+
+
+void test_collectives(agency::concurrent_agent& self)
+{
+  size_t n = self.group_size();
+  int rank = static_cast<int>(self.rank());
+  int sum_of_ranks = static_cast<int>(n * (n - 1) / 2);
+
+  // test reduce()
+  agency::experimental::optional<int> reduce_result = self.reduce(rank, std::plus<int>());
+  assert(bool(reduce_result) == (rank == 0));
+  if(rank == 0)
+  {
+    assert(*reduce_result == sum_of_ranks);
+  }
+
+  // test all_reduce()
+  assert(self.all_reduce(rank, std::plus<int>()) == sum_of_ranks);
+
+  // test inclusive_scan() and exclusive_scan()
+  assert(self.inclusive_scan(1, std::plus<int>()) == rank + 1);
+  assert(self.exclusive_scan(1, 10, std::plus<int>()) == rank + 10);
+
+  // test that values are combined in rank order
+  rank_range range{rank, rank, true};
+  assert(self.all_reduce(range, join_ranges()) == (rank_range{0, static_cast<int>(n) - 1, true}));
+  assert(self.inclusive_scan(range, join_ranges()) == (rank_range{0, rank, true}));
+  assert(self.exclusive_scan(range, rank_range{0, -1, true}, join_ranges()) == (rank_range{0, rank - 1, true}));
+
+  // test any() and all()
+  assert(self.any(rank == static_cast<int>(n) - 1));
+  assert(!self.any(false));
+  assert(self.all(true));
+  assert(self.all(rank == 0) == (n == 1));
+
+  // test a value larger than any before it, which grows the group's scratch space
+  large_value value;
+  value.data[0] = rank;
+  assert(self.all_reduce(value, add_first_elements()).data[0] == sum_of_ranks);
+
+  // test many consecutive collectives, which alternate between sets of slots
+  for(int i = 0; i < 100; ++i)
+  {
+    assert(self.all_reduce(rank + i, maximum()) == static_cast<int>(n) - 1 + i);
+  }
+}
+
+
+void test_collectives(size_t n)
+{
+  agency::bulk_invoke(agency::con(n), [](agency::concurrent_agent& self)
+  {
+    test_collectives(self);
+  });
+}
+
+
+void test_memory_size(size_t n)
+{
+  // the group's temporaries are larger than the group's built-in arena
+  const size_t num_elements = 1000;
+
+  auto policy = agency::con(n).memory_size(num_elements * sizeof(int));
+
+  assert(policy.param().domain().size() == n);
+  assert(policy.param().memory_size() == num_elements * sizeof(int));
+  assert(agency::con(n).param().memory_size() == 0);
+
+  // test that a default-initialized param_type reserves no memory
+  agency::concurrent_agent::param_type default_param;
+  assert(default_param.memory_size() == 0);
+
+  for(int launch = 0; launch < 3; ++launch)
+  {
+    agency::bulk_invoke(policy, [=](agency::concurrent_agent& self)
+    {
+      agency::shared_vector<int> data(self, num_elements, 0);
+
+      for(size_t i = self.rank(); i < num_elements; i += self.group_size())
+      {
+        data[i] = static_cast<int>(i) + launch;
+      }
+
+      self.wait();
+
+      for(size_t i = 0; i < num_elements; ++i)
+      {
+        assert(data[i] == static_cast<int>(i) + launch);
+      }
+
+      // test broadcast() of a value too large for the broadcast channel
+      large_value value;
+      value.data[19] = 13 + launch;
+
+      large_value result = self.broadcast(self.elect() ? agency::experimental::make_optional(value) : agency::experimental::nullopt);
+      assert(result.data[19] == 13 + launch);
+    });
+  }
+
+  // test that the inner policy's memory size applies to each inner group
+  agency::bulk_invoke(agency::par(2, agency::con(n).memory_size(num_elements * sizeof(int))), [=](agency::parallel_group<agency::concurrent_agent>& self)
+  {
+    agency::shared_vector<int> data(self.inner(), num_elements, 1);
+
+    assert(self.inner().all_reduce(data[self.inner().rank()], std::plus<int>()) == static_cast<int>(n));
+  });
+}
+
+
+int main()
+{
+  for(size_t n : {1, 2, 3, 16, 17, 64, 256, 257})
+  {
+    test_collectives(n);
+  }
+
+  {
+    // test collectives in a group large enough to require several phases
+    // fibers allow the group to be much larger than the number of threads
+
+    agency::experimental::fiber_executor exec(4);
+
+    agency::bulk_invoke(agency::con(4096 + 7).on(exec), [](agency::concurrent_agent& self)
+    {
+      test_collectives(self);
+    });
+  }
+
+  for(size_t n : {1, 4, 16})
+  {
+    test_memory_size(n);
+  }
+
+  {
+    // test collectives in a two-dimensional group
+
+    agency::bulk_invoke(agency::con2d({0,0}, {3,4}), [](agency::concurrent_agent_2d& self)
+    {
+      assert(self.all_reduce(1, std::plus<int>()) == 12);
+      assert(self.inclusive_scan(1, std::plus<int>()) == static_cast<int>(self.rank()) + 1);
+    });
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
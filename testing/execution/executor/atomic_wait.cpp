@@ -0,0 +1,111 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/latch.hpp>
+
+
+// one thread waits for another to change an atomic's value
+template<class T>
+void test_atomic_wait()
+{
+  std::atomic<T> a(T(0));
+
+  std::thread notifier([&]
+  {
+    // give the waiter a chance to block
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    a.store(T(1));
+    agency::detail::atomic_notify_one(a);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    a.store(T(2));
+    agency::detail::atomic_notify_all(a);
+  });
+
+  agency::detail::atomic_wait(a, T(0));
+  assert(a.load() != T(0));
+
+  agency::detail::atomic_wait(a, T(1));
+  assert(a.load() == T(2));
+
+  notifier.join();
+
+  // waiting for a value which is not current returns immediately
+  agency::detail::atomic_wait(a, T(0));
+}
+
+
+template<class Latch>
+void test_latch()
+{
+  {
+    // test count_down_and_wait() on a latch whose count is reached by several threads
+
+    const size_t num_threads = 8;
+    std::atomic<size_t> num_arrived(0);
+
+    Latch latch(num_threads);
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < num_threads; ++i)
+    {
+      threads.emplace_back([&]
+      {
+        ++num_arrived;
+        latch.count_down_and_wait();
+
+        assert(num_arrived == num_threads);
+      });
+    }
+
+    for(auto& t : threads)
+    {
+      t.join();
+    }
+
+    assert(latch.is_ready());
+  }
+
+  {
+    // test a latch which becomes ready long after its waiter blocks
+
+    Latch latch(2);
+
+    std::thread counter([&]
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      latch.count_down(2);
+    });
+
+    latch.wait();
+    assert(latch.is_ready());
+
+    counter.join();
+  }
+}
+
+
+int main()
+{
+  // int-sized types wait on a futex, when available
+  test_atomic_wait<int>();
+  test_atomic_wait<unsigned int>();
+
+  // larger types wait on a condition variable, unless the standard library provides atomic waits
+  test_atomic_wait<long long>();
+
+  test_latch<agency::detail::atomic_wait_latch>();
+  test_latch<agency::detail::condition_variable_latch>();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
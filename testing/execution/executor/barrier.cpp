@@ -0,0 +1,180 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+#include <agency/detail/concurrency/barrier.hpp>
+#include <agency/detail/concurrency/variant_barrier.hpp>
+#include <agency/detail/concurrency/arrive_and_wait.hpp>
+#include <agency/execution/execution_agent/concurrent_agent.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/execution/execution_policy.hpp>
+
+
+// each of num_threads threads arrives at the barrier num_phases times
+// after each phase, every thread checks that every other thread arrived during that phase
+template<class Barrier>
+void test_phases(size_t num_threads, bool indexed)
+{
+  const size_t num_phases = 20;
+
+  Barrier barrier(num_threads);
+  assert(barrier.count() == num_threads);
+
+  std::vector<std::atomic<size_t>> num_arrived(num_phases);
+  for(auto& n : num_arrived)
+  {
+    n = 0;
+  }
+
+  auto thread_body = [&](size_t index)
+  {
+    for(size_t phase = 0; phase < num_phases; ++phase)
+    {
+      ++num_arrived[phase];
+
+      if(indexed)
+      {
+        agency::detail::arrive_and_wait(barrier, index);
+      }
+      else
+      {
+        barrier.arrive_and_wait();
+      }
+
+      assert(num_arrived[phase] == num_threads);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for(size_t i = 1; i < num_threads; ++i)
+  {
+    threads.emplace_back(thread_body, i);
+  }
+
+  thread_body(0);
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+}
+
+
+template<class Barrier>
+void test_barrier(bool indexed)
+{
+  // test counts which yield trees of various shapes, including those with partially-filled nodes
+  for(size_t num_threads : {1, 2, 3, 4, 5, 16, 17, 33, 64})
+  {
+    test_phases<Barrier>(num_threads, indexed);
+  }
+}
+
+
+// num_threads - 1 threads arrive_and_wait() at the barrier while the final thread only arrive_and_drop()s
+template<class Barrier>
+void test_arrive_and_drop(size_t num_threads)
+{
+  const size_t num_phases = 20;
+
+  Barrier barrier(num_threads);
+
+  std::atomic<size_t> num_completed_phases(0);
+
+  std::vector<std::thread> threads;
+  for(size_t i = 1; i < num_threads; ++i)
+  {
+    threads.emplace_back([&,i]
+    {
+      for(size_t phase = 0; phase < num_phases; ++phase)
+      {
+        barrier.arrive_and_wait();
+
+        if(i == 1)
+        {
+          ++num_completed_phases;
+        }
+      }
+    });
+  }
+
+  for(size_t phase = 0; phase < num_phases; ++phase)
+  {
+    barrier.arrive_and_drop();
+
+    // the dropping thread waits for the phase to complete by other means before it arrives again
+    while(num_threads > 1 && num_completed_phases.load() == phase)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  assert(num_threads == 1 || num_completed_phases == num_phases);
+}
+
+
+struct spinning_or_tree_barrier : agency::detail::variant_barrier<agency::detail::spinning_barrier, agency::detail::tree_barrier>
+{
+  spinning_or_tree_barrier(size_t count)
+    : agency::detail::variant_barrier<agency::detail::spinning_barrier, agency::detail::tree_barrier>(1, count)
+  {}
+};
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  static_assert(has_indexed_arrive_and_wait<tree_barrier>::value, "tree_barrier should have indexed arrive_and_wait()");
+  static_assert(!has_indexed_arrive_and_wait<blocking_barrier>::value, "blocking_barrier should not have indexed arrive_and_wait()");
+
+
+  test_barrier<tree_barrier>(true);
+  test_barrier<tree_barrier>(false);
+
+  // arrive_and_wait(barrier, index) ignores the index of barriers which do not use it
+  test_barrier<blocking_barrier>(true);
+
+  // variant_barrier forwards the index to the barrier it contains
+  test_barrier<spinning_or_tree_barrier>(true);
+
+  for(size_t num_threads : {1, 2, 5, 17})
+  {
+    test_arrive_and_drop<tree_barrier>(num_threads);
+    test_arrive_and_drop<blocking_barrier>(num_threads);
+    test_arrive_and_drop<spinning_barrier>(num_threads);
+  }
+
+  {
+    // test concurrent_agent::wait() with a group larger than the tree's radix
+
+    const size_t n = 64;
+    std::atomic<size_t> num_arrived(0);
+
+    agency::bulk_invoke(agency::con(n), [&](agency::concurrent_agent& self)
+    {
+      for(size_t phase = 1; phase <= 10; ++phase)
+      {
+        ++num_arrived;
+        self.wait();
+
+        assert(num_arrived == phase * n);
+        self.wait();
+      }
+    });
+
+    assert(num_arrived == 10 * n);
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <future>
 #include <type_traits>
 #include <vector>
 #include <cassert>
@@ -7,6 +8,7 @@
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
 #include <agency/execution/executor/customization_points.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
 
 int main()
 {
@@ -27,15 +29,18 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, concurrent_executor>::value,
     "concurrent_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, concurrent_executor, int>::value,
-    "concurrent_executor should have std::future future");
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, concurrent_executor, int>::value,
+    "concurrent_executor should have agency::future future");
 
   static_assert(executor_execution_depth<concurrent_executor>::value == 1,
     "concurrent_executor should have execution_depth == 1");
 
+  static_assert(std::is_same<concurrent_executor, decltype(concurrent_executor().require(priority.high))>::value,
+    "concurrent_executor should accept the priority property");
+
   concurrent_executor exec;
 
-  std::future<int> fut = agency::make_ready_future<int>(exec, 7);
+  auto fut = agency::make_ready_future<int>(exec, 7);
 
   size_t shape = 10;
   
@@ -54,6 +59,28 @@ int main()
   
   assert(std::vector<int>(10, 7 + 13) == result);
 
+  {
+    // bulk_then_execute() with a std::future predecessor which is not yet ready
+
+    std::promise<int> promise;
+    std::future<int> predecessor_fut = promise.get_future();
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = past_arg + shared_arg[idx];
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    promise.set_value(7);
+
+    assert(std::vector<int>(10, 7 + 13) == f.get());
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
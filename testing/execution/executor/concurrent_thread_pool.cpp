@@ -0,0 +1,81 @@
+#include <iostream>
+#include <atomic>
+#include <future>
+#include <cassert>
+#include <memory>
+
+#include <agency/detail/concurrency/concurrent_thread_pool.hpp>
+#include <agency/detail/concurrency/latch.hpp>
+
+
+struct set_value_on_destruction
+{
+  std::promise<void> promise;
+
+  ~set_value_on_destruction()
+  {
+    promise.set_value();
+  }
+};
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  {
+    // test submit()
+
+    concurrent_thread_pool pool;
+
+    std::promise<int> promise;
+    auto fut = promise.get_future();
+
+    pool.submit([&]
+    {
+      promise.set_value(13);
+    });
+
+    assert(fut.get() == 13);
+    assert(pool.size() == 1);
+  }
+
+  {
+    // test that bulk_submit() executes its agents concurrently
+
+    concurrent_thread_pool pool;
+
+    size_t n = 64;
+
+    for(int trial = 0; trial < 10; ++trial)
+    {
+      std::atomic<int> counter(0);
+
+      // every agent waits for every other agent to arrive,
+      // which deadlocks unless all agents are concurrent
+      latch all_arrived(n);
+
+      auto done = std::make_shared<set_value_on_destruction>();
+      auto done_future = done->promise.get_future();
+
+      pool.bulk_submit([&all_arrived, &counter, done](size_t)
+      {
+        all_arrived.count_down_and_wait();
+        ++counter;
+      },
+      n);
+
+      done.reset();
+      done_future.wait();
+
+      assert(counter == static_cast<int>(n));
+    }
+
+    // threads are reused, but a thread may not yet have parked when the next trial begins
+    assert(pool.size() < 10 * n);
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
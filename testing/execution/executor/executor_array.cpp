@@ -49,7 +49,7 @@ void test(OuterExecutor, InnerExecutor inner_exec)
     // test .bulk_then_execute() with non-void predecessor
 
     shape_type shape(10,10);
-    std::future<int> predecessor_fut = make_ready_future<int>(exec, 7);
+    auto predecessor_fut = make_ready_future<int>(exec, 7);
 
     auto f = exec.bulk_then_execute(
       [=](index_type idx, int& predecessor, result_type& results, std::vector<int>& outer_shared_arg, std::vector<int>& inner_shared_arg)
@@ -75,7 +75,7 @@ void test(OuterExecutor, InnerExecutor inner_exec)
     // test .bulk_then_execute() with void predecessor
 
     shape_type shape(10,10);
-    std::future<void> predecessor_fut = make_ready_future<void>(exec);
+    auto predecessor_fut = make_ready_future<void>(exec);
 
     auto f = exec.bulk_then_execute(
       [=](index_type idx, result_type& results, std::vector<int>& outer_shared_arg, std::vector<int>& inner_shared_arg)
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <type_traits>
+#include <vector>
+#include <cassert>
+
+#include <agency/agency.hpp>
+#include <agency/execution/executor/experimental/fiber_executor.hpp>
+#include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
+
+int main()
+{
+  using namespace agency;
+
+  using executor_type = experimental::fiber_executor;
+
+  static_assert(is_executor<executor_type>::value,
+    "fiber_executor should be an executor");
+
+  static_assert(detail::is_bulk_then_executor<executor_type>::value,
+    "fiber_executor should be a bulk then executor");
+
+  static_assert(bulk_guarantee_t::static_query<executor_type>() == bulk_guarantee_t::concurrent_t(),
+    "fiber_executor should have concurrent static bulk guarantee");
+
+  static_assert(detail::is_detected_exact<size_t, executor_shape_t, executor_type>::value,
+    "fiber_executor should have size_t shape_type");
+
+  static_assert(detail::is_detected_exact<size_t, executor_index_t, executor_type>::value,
+    "fiber_executor should have size_t index_type");
+
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, executor_type, int>::value,
+    "fiber_executor should have agency::future future");
+
+  {
+    // bulk_then_execute()
+
+    executor_type exec;
+
+    auto fut = agency::make_ready_future<int>(exec, 7);
+
+    size_t shape = 10;
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = past_arg + shared_arg[idx];
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    auto result = f.get();
+
+    assert(std::vector<int>(10, 7 + 13) == result);
+  }
+
+  {
+    // a large group of concurrent agents which synchronize through their barrier
+    // use fewer threads than agents so that fibers must switch while waiting
+
+    executor_type exec(4);
+
+    size_t n = 4096;
+
+    std::vector<int> data(n, 1);
+
+    int result = bulk_invoke(con(n).on(exec), [&](concurrent_agent& self) -> single_result<int>
+    {
+      shared_vector<int> scratch(self, data);
+
+      auto i = self.index();
+      auto m = scratch.size();
+
+      while(m > 1)
+      {
+        if(i < m/2)
+        {
+          scratch[i] += scratch[m - i - 1];
+        }
+
+        self.wait();
+
+        m -= m/2;
+      }
+
+      if(i == 0)
+      {
+        return scratch[0];
+      }
+
+      return std::ignore;
+    });
+
+    assert(result == static_cast<int>(n));
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
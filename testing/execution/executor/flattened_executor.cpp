@@ -37,7 +37,7 @@ void test(OuterExecutor outer_exec, InnerExecutor inner_exec)
 
   flattened_executor_type exec(scoped_executor_type(outer_exec,inner_exec));
 
-  std::future<int> fut = make_ready_future<int>(exec, 7);
+  auto fut = make_ready_future<int>(exec, 7);
 
   using shape_type = executor_shape_t<flattened_executor_type>;
   shape_type shape(10);
@@ -7,6 +7,7 @@
 #include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
 #include <agency/execution/executor/customization_points.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
 
 int main()
 {
@@ -24,15 +25,15 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, parallel_executor>::value,
     "parallel_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, parallel_executor, int>::value,
-    "parallel_executor should have std::future future");
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, parallel_executor, int>::value,
+    "parallel_executor should have agency::future future");
 
   static_assert(executor_execution_depth<parallel_executor>::value == 1,
     "parallel_executor should have execution_depth == 1");
 
   parallel_executor exec;
 
-  std::future<int> fut = agency::make_ready_future<int>(exec, 7);
+  auto fut = agency::make_ready_future<int>(exec, 7);
 
   size_t shape = 10;
   
@@ -51,6 +52,35 @@ int main()
   
   assert(std::vector<int>(10, 7 + 13) == result);
 
+  {
+    // test that priority is forwarded to the thread pool executor
+
+    assert(exec.query(priority.normal));
+    assert(!exec.query(priority.high));
+
+    parallel_executor high_exec = exec.require(priority.high);
+
+    assert(high_exec.query(priority.high));
+    assert(high_exec.base_executor().outer_executor().query(priority.high));
+    assert(high_exec != exec);
+    assert(high_exec.require(priority.normal) == exec);
+
+    auto ready = agency::make_ready_future<void>(high_exec);
+
+    auto f = high_exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& results, int&)
+      {
+        results[idx] = 13;
+      },
+      shape,
+      ready,
+      [=]{ return std::vector<int>(shape); },     // results
+      []{ return 0; }                             // shared_arg
+    );
+
+    assert(std::vector<int>(10, 13) == f.get());
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
@@ -0,0 +1,103 @@
+#include <agency/agency.hpp>
+#include <agency/execution/executor.hpp>
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+
+
+template<class Schedule>
+void test(Schedule schedule)
+{
+  using namespace agency;
+
+  {
+    // test query()
+
+    auto ex = require(parallel_executor(), schedule);
+
+    static_assert(query(ex, bulk_guarantee) == bulk_guarantee_t::parallel_t(), "Parallel is not guaranteed.");
+    static_assert(std::is_same<Schedule, decltype(query(ex, schedule_t()))>::value, "Result of query is not the required schedule.");
+
+    // requiring another schedule replaces the first
+    auto other = require(ex, schedule_t().dynamic);
+    static_assert(std::is_same<decltype(require(parallel_executor(), schedule_t().dynamic)), decltype(other)>::value, "Schedules were not replaced.");
+
+    // sequenced executors are adapted to be parallel
+    auto seq_ex = require(sequenced_executor(), schedule);
+    static_assert(query(seq_ex, bulk_guarantee) == bulk_guarantee_t::parallel_t(), "Parallel is not guaranteed.");
+
+    // concurrent executors are adapted to be parallel
+    auto con_ex = require(concurrent_executor(), schedule);
+    static_assert(query(con_ex, bulk_guarantee) == bulk_guarantee_t::parallel_t(), "Parallel is not guaranteed.");
+  }
+
+  for(size_t n : {0, 1, 3, 100, 10000})
+  {
+    // test bulk_invoke() with each agent visiting its own index
+
+    std::vector<int> visited(n, 0);
+
+    bulk_invoke(par(n).require(schedule), [&](parallel_agent& self)
+    {
+      visited[self.index()] += 1;
+    });
+
+    assert(std::vector<int>(n, 1) == visited);
+  }
+
+  {
+    // test bulk_invoke() with results and a shared parameter
+
+    size_t n = 1000;
+
+    auto result = bulk_invoke(par(n).require(schedule), [](parallel_agent& self, int& shared_arg)
+    {
+      return static_cast<int>(self.index()) + shared_arg;
+    },
+    share(13));
+
+    std::vector<int> expected(n);
+    std::iota(expected.begin(), expected.end(), 13);
+
+    assert(std::equal(expected.begin(), expected.end(), result.begin()));
+  }
+
+  {
+    // test bulk_then_execute() with a non-void predecessor
+
+    auto ex = require(parallel_executor(), schedule);
+
+    auto predecessor = agency::make_ready_future<int>(ex, 7);
+
+    size_t n = 100;
+
+    auto f = ex.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = past_arg + shared_arg[idx];
+      },
+      n,
+      predecessor,
+      [=]{ return std::vector<int>(n); },    // results
+      [=]{ return std::vector<int>(n, 13); } // shared_arg
+    );
+
+    assert(std::vector<int>(n, 7 + 13) == f.get());
+  }
+}
+
+
+int main()
+{
+  test(agency::schedule.static_);
+  test(agency::schedule.dynamic);
+  test(agency::schedule.dynamic(16));
+  test(agency::schedule.guided);
+  test(agency::schedule.guided(4));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
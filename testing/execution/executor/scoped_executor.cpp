@@ -46,7 +46,7 @@ void test(OuterExecutor outer_exec, InnerExecutor inner_exec)
 
   scoped_executor_type exec(outer_exec,inner_exec);
 
-  std::future<int> fut = make_ready_future<int>(exec, 7);
+  auto fut = make_ready_future<int>(exec, 7);
 
   using shape_type = executor_shape_t<scoped_executor_type>;
   shape_type shape(10,10);
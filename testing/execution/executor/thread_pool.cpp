@@ -0,0 +1,824 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <future>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+// XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/future/promise.hpp>
+#include <agency/detail/concurrency/bounded_concurrent_queue.hpp>
+#include <agency/detail/unique_function.hpp>
+
+
+struct set_value_on_destruction
+{
+  std::promise<void> promise;
+
+  ~set_value_on_destruction()
+  {
+    promise.set_value();
+  }
+};
+
+
+// counts the allocations made by every copy of counting_allocator
+std::atomic<int> num_allocations(0);
+std::atomic<int> num_deallocations(0);
+
+template<class T>
+struct counting_allocator
+{
+  using value_type = T;
+
+  counting_allocator() = default;
+
+  template<class U>
+  counting_allocator(const counting_allocator<U>&) {}
+
+  T* allocate(size_t n)
+  {
+    ++num_allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, size_t n)
+  {
+    ++num_deallocations;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+};
+
+
+struct move_only_function
+{
+  std::unique_ptr<int> ptr;
+
+  int operator()() const
+  {
+    return *ptr;
+  }
+};
+
+
+void test_task_allocation()
+{
+  using namespace agency::detail;
+
+  // the tasks submitted by thread_pool::async() and bulk_submit() are stored inline
+  static_assert(unique_function<void()>::stores_inline<std::packaged_task<int()>>(), "std::packaged_task should be stored inline");
+  static_assert(unique_function<void()>::stores_inline<std::shared_ptr<int>>(), "std::shared_ptr should be stored inline");
+  static_assert(sizeof(unique_function<void()>) <= 64, "unique_function should fit in a cache line");
+
+  {
+    // test that small tasks do not allocate
+
+    std::atomic<int> counter(0);
+
+    {
+      basic_thread_pool<concurrent_queue, counting_allocator<char>> pool(2, thread_pool_mode::work_stealing);
+
+      for(int i = 0; i < 100; ++i)
+      {
+        pool.submit([&]{ ++counter; });
+      }
+
+      while(counter < 100)
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    assert(num_allocations == 0);
+  }
+
+  {
+    // test that large tasks are allocated by the pool's allocator
+
+    std::atomic<int> counter(0);
+
+    {
+      basic_thread_pool<concurrent_queue, counting_allocator<char>> pool(2, thread_pool_mode::shared_queue);
+
+      char large[128] = {};
+
+      for(int i = 0; i < 100; ++i)
+      {
+        pool.submit([&counter,large]{ counter += 1 + large[0]; });
+      }
+
+      while(counter < 100)
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    assert(num_allocations == 100);
+    assert(num_deallocations == 100);
+  }
+
+  {
+    // test that a move-only task moves between unique_functions
+
+    unique_function<int()> f = move_only_function{std::unique_ptr<int>(new int(13))};
+    unique_function<int()> g = std::move(f);
+
+    assert(!f);
+    assert(g() == 13);
+
+    f = std::move(g);
+    assert(f() == 13);
+  }
+}
+
+
+void test_placement()
+{
+  using namespace agency::detail;
+
+  // two nodes of four CPUs each
+  numa_topology topology({{0,1,2,3}, {4,5,6,7}});
+
+  assert(topology.num_nodes() == 2);
+  assert(topology.num_cpus() == 8);
+  assert(topology.node_of(5) == 1);
+  assert(topology.node_of(8) == 2);
+
+  {
+    // compact fills the first node before the second
+
+    placement_policy placement = placement_policy::compact();
+
+    assert(placement.default_num_threads(topology) == 8);
+    assert(placement.worker_cpus(0, topology) == std::vector<int>{0});
+    assert(placement.worker_cpus(3, topology) == std::vector<int>{3});
+    assert(placement.worker_cpus(4, topology) == std::vector<int>{4});
+    assert(placement.worker_cpus(9, topology) == std::vector<int>{1});
+    assert(placement.worker_node(3, topology) == 0);
+  }
+
+  {
+    // scatter alternates between the nodes
+
+    placement_policy placement = placement_policy::scatter();
+
+    assert(placement.worker_cpus(0, topology) == std::vector<int>{0});
+    assert(placement.worker_cpus(1, topology) == std::vector<int>{4});
+    assert(placement.worker_cpus(2, topology) == std::vector<int>{1});
+    assert(placement.worker_cpus(3, topology) == std::vector<int>{5});
+    assert(placement.worker_node(3, topology) == 1);
+  }
+
+  {
+    // cpus follows the explicit list
+
+    placement_policy placement = placement_policy::cpus({6,2});
+
+    assert(placement.default_num_threads(topology) == 2);
+    assert(placement.worker_cpus(0, topology) == std::vector<int>{6});
+    assert(placement.worker_cpus(1, topology) == std::vector<int>{2});
+    assert(placement.worker_cpus(2, topology) == std::vector<int>{6});
+  }
+
+  {
+    // numa_node lets each worker run anywhere on its node
+
+    placement_policy placement = placement_policy::numa_node(1);
+
+    assert(placement.default_num_threads(topology) == 4);
+    assert(placement.worker_cpus(0, topology) == topology.cpus(1));
+    assert(placement.worker_node(2, topology) == 1);
+
+    bool caught = false;
+    try
+    {
+      placement_policy::numa_node(2).worker_cpus(0, topology);
+    }
+    catch(std::out_of_range&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  {
+    // unpinned workers have no CPUs
+
+    assert(placement_policy::unpinned().worker_cpus(0, topology).empty());
+    assert(placement_policy::unpinned().worker_node(0, topology) == 2);
+  }
+
+  {
+    // test a pool per NUMA node of the system
+
+    std::vector<std::unique_ptr<thread_pool>> pools;
+
+    for(size_t node = 0; node < numa_topology::system().num_nodes(); ++node)
+    {
+      pools.emplace_back(new thread_pool(placement_policy::numa_node(node)));
+
+      assert(pools.back()->size() == numa_topology::system().cpus(node).size());
+      assert(pools.back()->worker_cpus(0) == numa_topology::system().cpus(node));
+    }
+
+    for(auto& pool : pools)
+    {
+      assert(pool->async([]{ return 13; }).get() == 13);
+    }
+  }
+}
+
+
+void test_elasticity()
+{
+  using namespace agency::detail;
+
+  {
+    // test that an elastic pool starts workers lazily and retires them when idle
+
+    thread_pool pool(thread_pool_elasticity(0, 4, std::chrono::milliseconds(10)));
+
+    assert(pool.size() == 4);
+    assert(pool.num_running_threads() == 0);
+
+    std::vector<std::future<int>> futures;
+    for(int i = 0; i < 100; ++i)
+    {
+      futures.push_back(pool.async([](int x){ return x; }, i));
+    }
+
+    for(int i = 0; i < 100; ++i)
+    {
+      assert(futures[i].get() == i);
+    }
+
+    assert(pool.num_running_threads() > 0);
+    assert(pool.num_running_threads() <= 4);
+
+    // wait for the workers to retire
+    while(pool.num_running_threads() > 0)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // test that the pool restarts workers after they retire
+    assert(pool.async([]{ return 13; }).get() == 13);
+
+    std::atomic<int> sum(0);
+    auto done = std::make_shared<set_value_on_destruction>();
+    auto done_future = done->promise.get_future();
+
+    pool.bulk_submit([&sum, done](size_t idx)
+    {
+      sum += idx;
+    },
+    100);
+
+    done.reset();
+    done_future.wait();
+
+    assert(sum == 4950);
+  }
+
+  {
+    // test that an elastic pool keeps its minimum number of workers
+
+    thread_pool pool(thread_pool_elasticity(2, 3, std::chrono::milliseconds(1)));
+
+    assert(pool.num_running_threads() == 2);
+
+    for(int i = 0; i < 10; ++i)
+    {
+      pool.async([]{}).wait();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    assert(pool.num_running_threads() >= 2);
+  }
+
+  {
+    // test that a waiting worker of a single-worker elastic pool helps execute the task it waits on
+
+    thread_pool pool(thread_pool_elasticity(0, 1, std::chrono::milliseconds(1)));
+
+    auto fut = pool.async([&]
+    {
+      auto promise = std::make_shared<agency::promise<int>>();
+      agency::future<int> inner = promise->get_future();
+
+      pool.submit([=]
+      {
+        promise->set_value(7);
+      });
+
+      return inner.get();
+    });
+
+    assert(fut.get() == 7);
+  }
+
+  {
+    // test thread_pool_elasticity::from_environment()
+
+    setenv("AGENCY_NUM_THREADS", "3", 1);
+    setenv("AGENCY_MIN_THREADS", "5", 1);
+    setenv("AGENCY_THREAD_IDLE_MS", "250", 1);
+
+    thread_pool_elasticity elasticity = thread_pool_elasticity::from_environment();
+
+    assert(elasticity.max_threads == 3);
+    assert(elasticity.min_threads == 3);
+    assert(elasticity.idle_timeout == std::chrono::milliseconds(250));
+
+    setenv("AGENCY_NUM_THREADS", "not a number", 1);
+    unsetenv("AGENCY_MIN_THREADS");
+    unsetenv("AGENCY_THREAD_IDLE_MS");
+
+    elasticity = thread_pool_elasticity::from_environment();
+
+    assert(elasticity.max_threads == thread_pool_elasticity().max_threads);
+    assert(elasticity.min_threads == 0);
+
+    unsetenv("AGENCY_NUM_THREADS");
+  }
+}
+
+
+void test_spinning()
+{
+  using namespace agency::detail;
+
+  {
+    // test that spinning is disabled by default and may be configured
+
+    thread_pool pool(2);
+
+    assert(!pool.spinning().is_enabled());
+
+    pool.set_spinning(thread_pool_spinning(1, std::chrono::microseconds(500)));
+
+    assert(pool.spinning().max_spinning_workers == 1);
+    assert(pool.spinning().spin_duration == std::chrono::microseconds(500));
+
+    // shared_queue pools do not spin
+    thread_pool shared_pool(2, thread_pool_mode::shared_queue);
+    shared_pool.set_spinning(thread_pool_spinning(1, std::chrono::microseconds(500)));
+
+    assert(!shared_pool.spinning().is_enabled());
+  }
+
+  {
+    // test that spinning workers execute every task, whether received through a mailbox or a queue
+
+    thread_pool pool(4);
+    pool.set_spinning(thread_pool_spinning(2, std::chrono::milliseconds(2)));
+
+    for(int trial = 0; trial < 100; ++trial)
+    {
+      std::atomic<int> sum(0);
+      auto done = std::make_shared<set_value_on_destruction>();
+      auto done_future = done->promise.get_future();
+
+      pool.bulk_submit([&sum, done](size_t idx)
+      {
+        sum += idx;
+      },
+      100);
+
+      done.reset();
+      done_future.wait();
+
+      assert(sum == 4950);
+    }
+
+    std::vector<std::future<int>> futures;
+    for(int i = 0; i < 100; ++i)
+    {
+      futures.push_back(pool.async([](int x){ return x; }, i));
+    }
+
+    for(int i = 0; i < 100; ++i)
+    {
+      assert(futures[i].get() == i);
+    }
+  }
+
+  {
+    // test that an elastic pool's spinning workers still retire
+
+    thread_pool pool(thread_pool_elasticity(0, 2, std::chrono::milliseconds(5)));
+    pool.set_spinning(thread_pool_spinning(2, std::chrono::microseconds(100)));
+
+    assert(pool.async([]{ return 13; }).get() == 13);
+
+    while(pool.num_running_threads() > 0)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  {
+    // test thread_pool_spinning::from_environment()
+
+    setenv("AGENCY_SPINNING_THREADS", "2", 1);
+    setenv("AGENCY_SPIN_US", "50", 1);
+
+    thread_pool_spinning spinning = thread_pool_spinning::from_environment();
+
+    assert(spinning.max_spinning_workers == 2);
+    assert(spinning.spin_duration == std::chrono::microseconds(50));
+
+    unsetenv("AGENCY_SPINNING_THREADS");
+    unsetenv("AGENCY_SPIN_US");
+
+    assert(!thread_pool_spinning::from_environment().is_enabled());
+  }
+}
+
+
+template<class ThreadPool>
+void test(agency::detail::thread_pool_mode mode)
+{
+  using namespace agency::detail;
+
+  {
+    // test async()
+
+    ThreadPool pool(4, mode);
+
+    assert(pool.size() == 4);
+    assert(pool.mode() == mode);
+
+    std::vector<std::future<int>> futures;
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      futures.push_back(pool.async([](int x){ return x; }, i));
+    }
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      assert(futures[i].get() == i);
+    }
+  }
+
+  {
+    // test that a worker which waits on the std::future of its own submission does not deadlock
+
+    ThreadPool pool(1, mode);
+
+    auto fut = pool.async([&]
+    {
+      return pool.async([]{ return 13; }).get();
+    });
+
+    assert(fut.get() == 13);
+  }
+
+  {
+    // test submit()
+
+    std::atomic<int> counter(0);
+
+    {
+      ThreadPool pool(4, mode);
+
+      for(int i = 0; i < 1000; ++i)
+      {
+        pool.submit([&]{ ++counter; });
+      }
+
+      // wait for all tasks to execute
+      while(counter < 1000)
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    assert(counter == 1000);
+  }
+
+  {
+    // test bulk_submit()
+
+    ThreadPool pool(4, mode);
+
+    for(size_t n : {0, 1, 3, 4, 100, 100000})
+    {
+      std::vector<std::atomic<int>> visited(n);
+      for(auto& v : visited) v = 0;
+
+      // the promise is fulfilled when the last copy of the function is destroyed,
+      // which happens after the final invocation completes
+      auto done = std::make_shared<set_value_on_destruction>();
+      auto done_future = done->promise.get_future();
+
+      pool.bulk_submit([&visited, done](size_t idx)
+      {
+        ++visited[idx];
+      },
+      n);
+
+      done.reset();
+      done_future.wait();
+
+      for(auto& v : visited)
+      {
+        assert(v == 1);
+      }
+    }
+  }
+
+  {
+    // test submission from within the pool
+
+    ThreadPool pool(4, mode);
+
+    std::atomic<int> counter(0);
+
+    auto fut = pool.async([&]
+    {
+      for(int i = 0; i < 100; ++i)
+      {
+        pool.submit([&]{ ++counter; });
+      }
+    });
+
+    fut.wait();
+
+    while(counter < 100)
+    {
+      std::this_thread::yield();
+    }
+
+    assert(counter == 100);
+  }
+
+  {
+    // test that a high priority task submitted behind a long bulk launch executes between its chunks
+    // the pool has a single worker, so the high priority task would otherwise wait for the whole launch
+
+    ThreadPool pool(1, mode);
+
+    const size_t n = 100 * ThreadPool::max_bulk_chunk_size;
+
+    std::atomic<size_t> counter(0);
+    std::atomic<bool> high_priority_task_submitted(false);
+    std::promise<size_t> counter_when_high_priority_task_executed;
+
+    auto done = std::make_shared<set_value_on_destruction>();
+    auto done_future = done->promise.get_future();
+
+    pool.bulk_submit([&, done](size_t)
+    {
+      // don't let the launch progress until the high priority task is waiting
+      while(!high_priority_task_submitted)
+      {
+        std::this_thread::yield();
+      }
+
+      ++counter;
+    },
+    n);
+
+    pool.submit([&]
+    {
+      counter_when_high_priority_task_executed.set_value(counter.load());
+    },
+    task_priority::high);
+
+    high_priority_task_submitted = true;
+
+    assert(counter_when_high_priority_task_executed.get_future().get() <= ThreadPool::max_bulk_chunk_size);
+
+    done.reset();
+    done_future.wait();
+
+    assert(counter == n);
+  }
+
+  if(mode == thread_pool_mode::work_stealing)
+  {
+    // test that a worker which waits on a future helps execute the task which fulfills it
+    // the pool has a single worker, so the wait would deadlock if it blocked the worker
+
+    ThreadPool pool(1, mode);
+
+    auto fut = pool.async([&]
+    {
+      int sum = 0;
+
+      for(int i = 0; i < 10; ++i)
+      {
+        auto promise = std::make_shared<agency::promise<int>>();
+        agency::future<int> inner = promise->get_future();
+
+        pool.submit([=]
+        {
+          promise->set_value(i);
+        });
+
+        sum += inner.get();
+      }
+
+      return sum;
+    });
+
+    assert(fut.get() == 45);
+  }
+
+  {
+    // test bulk_invoke()
+
+    ThreadPool pool(4, mode);
+
+    std::vector<int> results(1000);
+    std::atomic<int> num_invocations(0);
+
+    pool.bulk_invoke([&](size_t idx)
+    {
+      results[idx] = idx;
+      ++num_invocations;
+    },
+    results.size());
+
+    // bulk_invoke() returns only after every invocation completes
+    assert(num_invocations == 1000);
+    for(int i = 0; i < 1000; ++i)
+    {
+      assert(results[i] == i);
+    }
+
+    // test empty and single-agent launches, which submit nothing to the pool
+    pool.bulk_invoke([&](size_t){ ++num_invocations; }, 0);
+    pool.bulk_invoke([&](size_t){ ++num_invocations; }, 1);
+    assert(num_invocations == 1001);
+
+    // test a function which is neither copyable nor movable
+    struct noncopyable_function
+    {
+      std::atomic<int> sum;
+
+      noncopyable_function() : sum(0) {}
+      noncopyable_function(const noncopyable_function&) = delete;
+
+      void operator()(size_t idx)
+      {
+        sum += idx;
+      }
+    };
+
+    noncopyable_function f;
+    pool.bulk_invoke(f, 100);
+    assert(f.sum == 4950);
+
+    // test a launch from one of the pool's workers, which executes its agents while its siblings are busy
+    auto fut = pool.async([&]
+    {
+      std::atomic<int> sum(0);
+
+      pool.bulk_invoke([&](size_t idx)
+      {
+        sum += idx;
+      },
+      100,
+      2);
+
+      return sum.load();
+    });
+
+    assert(fut.get() == 4950);
+  }
+
+  {
+    // test that the caller of bulk_invoke() executes every invocation when the pool's workers are busy
+
+    ThreadPool pool(1, mode);
+
+    std::promise<void> release_worker;
+    std::shared_future<void> worker_released = release_worker.get_future().share();
+
+    std::future<void> busy = pool.async([=]{ worker_released.wait(); });
+
+    std::thread::id caller = std::this_thread::get_id();
+    std::atomic<int> num_invocations_on_caller(0);
+
+    pool.bulk_invoke([&](size_t)
+    {
+      if(std::this_thread::get_id() == caller)
+      {
+        ++num_invocations_on_caller;
+      }
+    },
+    10);
+
+    assert(num_invocations_on_caller == 10);
+
+    // test that an exception thrown on the caller abandons the unclaimed invocations and propagates to the caller
+    std::atomic<int> num_invocations(0);
+
+    bool caught = false;
+    try
+    {
+      pool.bulk_invoke([&](size_t idx)
+      {
+        ++num_invocations;
+
+        if(idx == 3)
+        {
+          throw std::runtime_error("error");
+        }
+      },
+      10);
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+    assert(num_invocations == 4);
+
+    release_worker.set_value();
+    busy.get();
+
+    // test that the pool still works after the exception
+    pool.bulk_invoke([&](size_t){ ++num_invocations; }, 10);
+    assert(num_invocations == 14);
+  }
+
+  {
+    // test that bulk_invoke() rethrows an exception thrown on any participant
+    // only after every invocation in progress has completed
+
+    ThreadPool pool(4, mode);
+
+    for(int trial = 0; trial < 10; ++trial)
+    {
+      std::atomic<int> num_in_progress(0);
+
+      struct in_progress_guard
+      {
+        std::atomic<int>& count;
+
+        in_progress_guard(std::atomic<int>& c) : count(c) { ++count; }
+        ~in_progress_guard() { --count; }
+      };
+
+      bool caught = false;
+      try
+      {
+        pool.bulk_invoke([&](size_t idx)
+        {
+          in_progress_guard guard(num_in_progress);
+
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+
+          if(idx % 7 == 3)
+          {
+            throw std::runtime_error("error");
+          }
+        },
+        100);
+      }
+      catch(std::runtime_error&)
+      {
+        caught = true;
+      }
+
+      assert(caught);
+      assert(num_in_progress == 0);
+    }
+  }
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  test<thread_pool>(thread_pool_mode::shared_queue);
+  test<thread_pool>(thread_pool_mode::work_stealing);
+
+  test<basic_thread_pool<bounded_concurrent_queue>>(thread_pool_mode::shared_queue);
+
+  test_task_allocation();
+
+  test_placement();
+
+  test_elasticity();
+
+  test_spinning();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
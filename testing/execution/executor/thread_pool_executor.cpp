@@ -1,13 +1,85 @@
 #include <iostream>
 #include <type_traits>
 #include <vector>
+#include <atomic>
+#include <future>
+#include <cassert>
+#include <stdexcept>
 
 // XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
 #include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/bulk_invoke.hpp>
+#include <agency/bulk_async.hpp>
+#include <agency/execution/execution_policy.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
+#include <agency/execution/executor/executor_traits/detail/is_single_twoway_executor.hpp>
+#include <agency/execution/executor/executor_traits/detail/is_single_then_executor.hpp>
+#include <agency/execution/executor/executor_traits/detail/has_bulk_sync_execute_member.hpp>
 #include <agency/execution/executor/customization_points.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/async.hpp>
+
+
+// a copyable future whose .then() does not invoke its continuation when the future is exceptional
+// its continuations execute immediately in the calling thread
+template<class T>
+class exception_skipping_future;
+
+template<>
+class exception_skipping_future<void>
+{
+  public:
+    explicit exception_skipping_future(std::shared_future<void> fut)
+      : fut_(fut)
+    {}
+
+    bool valid() const
+    {
+      return fut_.valid();
+    }
+
+    void wait() const
+    {
+      fut_.wait();
+    }
+
+    void get() const
+    {
+      fut_.get();
+    }
+
+    template<class Function>
+    std::shared_future<void> then(Function f) const
+    {
+      std::promise<void> result;
+
+      try
+      {
+        fut_.get();
+        f();
+        result.set_value();
+      }
+      catch(...)
+      {
+        result.set_exception(std::current_exception());
+      }
+
+      return result.get_future().share();
+    }
+
+  private:
+    std::shared_future<void> fut_;
+};
+
+
+exception_skipping_future<void> make_exceptional_exception_skipping_future()
+{
+  std::promise<void> promise;
+  promise.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+  return exception_skipping_future<void>(promise.get_future().share());
+}
 
 
 int main()
@@ -17,6 +89,12 @@ int main()
   static_assert(detail::is_bulk_then_executor<detail::thread_pool_executor>::value,
     "thread_pool_executor should be a bulk then executor");
 
+  static_assert(detail::is_single_twoway_executor<detail::thread_pool_executor>::value,
+    "thread_pool_executor should be a single twoway executor");
+
+  static_assert(detail::is_single_then_executor<detail::thread_pool_executor>::value,
+    "thread_pool_executor should be a single then executor");
+
   static_assert(bulk_guarantee_t::static_query<detail::thread_pool_executor>() == bulk_guarantee_t::parallel_t(),
     "thread_pool_executor should have parallel static bulk guarantee");
 
@@ -26,8 +104,8 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, detail::thread_pool_executor>::value,
     "thread_pool_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, detail::thread_pool_executor, int>::value,
-    "thread_pool_executor should have std::future future");
+  static_assert(detail::is_detected_exact<agency::future<int>, executor_future_t, detail::thread_pool_executor, int>::value,
+    "thread_pool_executor should have agency::future future");
 
   static_assert(executor_execution_depth<detail::thread_pool_executor>::value == 1,
     "thread_pool_executor should have execution_depth == 1");
@@ -38,7 +116,7 @@ int main()
   {
     // bulk_then_execute() with non-void predecessor
     
-    std::future<int> predecessor_fut = agency::make_ready_future<int>(exec, 7);
+    auto predecessor_fut = agency::make_ready_future<int>(exec, 7);
 
     size_t shape = 10;
     
@@ -62,7 +140,7 @@ int main()
   {
     // bulk_then_execute() with void predecessor
     
-    std::future<void> predecessor_fut = agency::make_ready_future<void>(exec);
+    auto predecessor_fut = agency::make_ready_future<void>(exec);
 
     size_t shape = 10;
     
@@ -82,6 +160,361 @@ int main()
     assert(std::vector<int>(10, 13) == result);
   }
 
+  {
+    // bulk_then_execute() with a predecessor which becomes ready only after a task
+    // submitted later to the same thread pool executes
+    // this test deadlocks if agents occupy the pool's threads waiting on the predecessor
+
+    std::promise<int> promise;
+    std::future<int> predecessor_fut = promise.get_future();
+
+    size_t shape = 4 * exec.unit_shape();
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& predecessor, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = predecessor + shared_arg[idx];
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    // chain another launch onto the first
+    auto g = exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& predecessor, std::vector<int>& results, int&)
+      {
+        results[idx] = predecessor[idx] + 1;
+      },
+      shape,
+      f,
+      [=]{ return std::vector<int>(shape); },     // results
+      []{ return 0; }                             // shared_arg
+    );
+
+    detail::system_thread_pool().submit([&]
+    {
+      promise.set_value(7);
+    });
+
+    auto result = g.get();
+
+    assert(std::vector<int>(shape, 7 + 13 + 1) == result);
+  }
+
+  {
+    // test an executor of a pool with pinned workers
+
+    detail::thread_pool pool(detail::placement_policy::compact());
+    detail::thread_pool_executor pool_exec(pool);
+
+    assert(pool_exec != exec);
+    assert(pool_exec == detail::thread_pool_executor(pool));
+    assert(pool_exec.unit_shape() == pool.size());
+    assert(pool_exec.query(detail::thread_placement) == detail::placement_policy::compact());
+    assert(exec.query(detail::thread_placement) == detail::placement_policy::unpinned());
+
+    auto predecessor_fut = agency::make_ready_future<void>(pool_exec);
+
+    size_t shape = 10;
+
+    auto f = pool_exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& results, int&)
+      {
+        results[idx] = idx;
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); }, // results
+      []{ return 0; }                         // shared_arg
+    );
+
+    auto result = f.get();
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == int(i));
+    }
+  }
+
+  {
+    // test executors of independent pools
+
+    detail::thread_pool pool1(2);
+    detail::thread_pool pool2(2);
+
+    detail::thread_pool_executor exec1(pool1);
+    detail::thread_pool_executor exec2(pool2);
+
+    assert(exec1 == detail::thread_pool_executor(pool1));
+    assert(exec1 != exec2);
+    assert(exec1 != detail::thread_pool_executor(pool1, 1));
+
+    // test use through par.on()
+    std::atomic<int> sum(0);
+    agency::bulk_invoke(agency::par(100).on(exec1), [&](agency::parallel_agent& self)
+    {
+      sum += self.index();
+    });
+
+    assert(sum == 4950);
+
+    auto fut = agency::bulk_async(agency::par(10).on(exec2), [](agency::parallel_agent& self)
+    {
+      return self.index();
+    });
+
+    auto results = fut.get();
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+      assert(results[i] == i);
+    }
+  }
+
+  {
+    // test that a tenant's concurrency quota leaves workers free for other tenants of the same pool
+
+    detail::thread_pool pool(2);
+
+    detail::thread_pool_executor tenant1(pool, 1);
+    detail::thread_pool_executor tenant2(pool, 1);
+
+    assert(tenant1.unit_shape() == 1);
+
+    // tenant1's agents block until tenant2's launch completes
+    // without the quota, tenant1's agents would occupy both workers and tenant2 would never run
+    std::promise<void> tenant2_finished;
+    std::shared_future<void> tenant2_finished_future = tenant2_finished.get_future().share();
+
+    auto blocked = agency::bulk_async(agency::par(10).on(tenant1), [=](agency::parallel_agent&)
+    {
+      tenant2_finished_future.wait();
+    });
+
+    agency::bulk_invoke(agency::par(10).on(tenant2), [](agency::parallel_agent&){});
+
+    tenant2_finished.set_value();
+
+    blocked.wait();
+  }
+
+  {
+    // test priority
+
+    assert(exec.query(priority.normal));
+    assert(!exec.query(priority.high));
+
+    auto high_exec = exec.require(priority.high);
+
+    assert(high_exec.query(priority.high));
+    assert(high_exec != exec);
+    assert(high_exec.require(priority.normal) == exec);
+
+    assert(agency::async(high_exec, []{ return 13; }).get() == 13);
+  }
+
+  {
+    // twoway_execute()
+
+    auto f = exec.twoway_execute([]{ return 13; });
+    assert(f.get() == 13);
+
+    std::atomic<int> counter(0);
+    auto g = exec.twoway_execute([&]{ ++counter; });
+    g.wait();
+    assert(counter == 1);
+
+    auto h = exec.twoway_execute([]() -> int { throw std::runtime_error("error"); });
+
+    bool caught = false;
+    try
+    {
+      h.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  {
+    // then_execute() with non-void predecessor
+
+    auto predecessor_fut = agency::make_ready_future<int>(exec, 7);
+
+    auto f = exec.then_execute([](int& predecessor){ return predecessor + 13; }, predecessor_fut);
+
+    assert(f.get() == 7 + 13);
+  }
+
+  {
+    // then_execute() with void predecessor which is not yet ready
+
+    agency::promise<void> predecessor;
+    auto predecessor_fut = predecessor.get_future();
+
+    auto f = exec.then_execute([]{ return 13; }, predecessor_fut);
+
+    predecessor.set_value();
+
+    assert(f.get() == 13);
+  }
+
+  {
+    // then_execute() with a std::future predecessor which is not yet ready
+
+    std::promise<int> predecessor;
+    std::future<int> predecessor_fut = predecessor.get_future();
+
+    auto f = exec.then_execute([](int& predecessor){ return predecessor + 13; }, predecessor_fut);
+
+    predecessor.set_value(7);
+
+    assert(f.get() == 7 + 13);
+  }
+
+  {
+    // then_execute() with exceptional predecessor
+
+    agency::promise<int> predecessor;
+    auto predecessor_fut = predecessor.get_future();
+
+    predecessor.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+
+    auto f = exec.then_execute([](int& predecessor){ return predecessor; }, predecessor_fut);
+
+    bool caught = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  {
+    // then_execute() with an exceptional predecessor whose .then() would not invoke a continuation
+
+    exception_skipping_future<void> predecessor_fut = make_exceptional_exception_skipping_future();
+
+    auto f = exec.then_execute([]{ return 13; }, predecessor_fut);
+
+    bool caught = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  {
+    // bulk_then_execute() with an exceptional predecessor whose .then() would not invoke a continuation
+
+    exception_skipping_future<void> predecessor_fut = make_exceptional_exception_skipping_future();
+
+    size_t shape = 10;
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = shared_arg[idx];
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    bool caught = false;
+    try
+    {
+      f.get();
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  {
+    // bulk_sync_execute()
+
+    size_t shape = 100;
+
+    auto result = exec.bulk_sync_execute(
+      [&](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = shared_arg[idx];
+      },
+      shape,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    assert(std::vector<int>(shape, 13) == result);
+
+    // test that an exception thrown by an agent propagates to the caller
+    bool caught = false;
+    try
+    {
+      exec.bulk_sync_execute(
+        [&](size_t idx, std::vector<int>&, std::vector<int>&)
+        {
+          if(idx == shape / 2)
+          {
+            throw std::runtime_error("error");
+          }
+        },
+        shape,
+        [=]{ return std::vector<int>(shape); },
+        [=]{ return std::vector<int>(shape); }
+      );
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  {
+    // bulk_invoke() on a parallel_executor executes its agents through bulk_sync_execute()
+
+    static_assert(detail::has_bulk_sync_execute_member<
+      parallel_executor,
+      void(*)(size_t, int&, int&),
+      size_t,
+      detail::construct<int>,
+      detail::construct<int>
+    >::value, "parallel_executor should have bulk_sync_execute()");
+
+    auto result = agency::bulk_invoke(agency::par(100), [](agency::parallel_agent& self, int& shared_arg)
+    {
+      return static_cast<int>(self.index()) + shared_arg;
+    },
+    agency::share(7));
+
+    for(int i = 0; i < 100; ++i)
+    {
+      assert(result[i] == i + 7);
+    }
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
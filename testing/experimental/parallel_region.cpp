@@ -0,0 +1,140 @@
+#include <agency/agency.hpp>
+#include <agency/experimental/parallel_region.hpp>
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <numeric>
+#include <atomic>
+#include <stdexcept>
+
+void test()
+{
+  using namespace agency::experimental;
+
+  {
+    // test that every member of the team executes the body
+
+    std::vector<int> visited(8, 0);
+
+    parallel_region(visited.size(), [&](parallel_team& team)
+    {
+      assert(team.size() == visited.size());
+      visited[team.index()] += 1;
+    });
+
+    assert(std::vector<int>(8, 1) == visited);
+  }
+
+  {
+    // test an iterative loop in which each iteration reads the result of the previous one
+
+    size_t n = 1000;
+    size_t num_iterations = 100;
+
+    std::vector<int> a(n, 0), b(n, 0);
+
+    parallel_region(4, [&](parallel_team& team)
+    {
+      for(size_t iter = 0; iter < num_iterations; ++iter)
+      {
+        std::vector<int>& src = (iter % 2) ? b : a;
+        std::vector<int>& dst = (iter % 2) ? a : b;
+
+        team.for_each(n, [&](size_t i)
+        {
+          // read a neighbor which may belong to another member
+          dst[i] = src[(i + 1) % n] + 1;
+        });
+      }
+    });
+
+    std::vector<int>& result = (num_iterations % 2) ? b : a;
+    assert(std::vector<int>(n, num_iterations) == result);
+  }
+
+  {
+    // test single()
+
+    std::atomic<int> counter(0);
+    int observed = 0;
+
+    parallel_region(4, [&](parallel_team& team)
+    {
+      team.single([&]
+      {
+        ++counter;
+      });
+
+      // every member observes the single member's effect
+      if(counter.load() != 1)
+      {
+        observed = -1;
+      }
+    });
+
+    assert(counter.load() == 1);
+    assert(observed == 0);
+  }
+
+  {
+    // test the default team size
+
+    std::atomic<size_t> team_size(0);
+
+    parallel_region([&](parallel_team& team)
+    {
+      team.single([&]
+      {
+        team_size = team.size();
+      });
+    });
+
+    assert(team_size.load() == agency::detail::system_thread_pool().size());
+  }
+
+  {
+    // test many consecutive short regions, whose callers return as soon as their teammates finish
+
+    std::atomic<int> counter(0);
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      parallel_region(2, [&](parallel_team&)
+      {
+        ++counter;
+      });
+    }
+
+    assert(counter.load() == 2000);
+  }
+
+  {
+    // test that an exception thrown by every member is rethrown
+
+    bool caught = false;
+
+    try
+    {
+      parallel_region(4, [](parallel_team& team)
+      {
+        team.wait();
+        throw std::runtime_error("error");
+      });
+    }
+    catch(std::runtime_error&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+}
+
+int main()
+{
+  test();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
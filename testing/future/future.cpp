@@ -0,0 +1,319 @@
+#include <cassert>
+#include <agency/future/future.hpp>
+#include <agency/future/promise.hpp>
+#include <agency/future/future_traits.hpp>
+#include <agency/future/future_traits/detail/has_then_member.hpp>
+#include <agency/execution/executor/parallel_executor.hpp>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+int main()
+{
+  using namespace agency;
+
+  static_assert(is_future<future<int>>::value, "future<int> is not a future");
+  static_assert(is_future<shared_future<int>>::value, "shared_future<int> is not a future");
+
+  static_assert(detail::has_then_member<future<int>, void(*)(int&)>::value, "future<int>::then() is not monadic");
+  static_assert(detail::has_then_member<future<void>, int(*)()>::value, "future<void>::then() is not monadic");
+
+  static_assert(std::is_same<future_traits<future<int>>::shared_future_type, shared_future<int>>::value,
+    "future<int>'s shared future should be shared_future<int>");
+
+  {
+    // default construct
+    future<int> f0;
+    assert(!f0.valid());
+  }
+
+  {
+    // make_ready int
+    future<int> f0 = future<int>::make_ready(13);
+    assert(f0.valid());
+    assert(f0.is_ready());
+    assert(f0.get() == 13);
+    assert(!f0.valid());
+  }
+
+  {
+    // make_ready void
+    future<void> f0 = future<void>::make_ready();
+    assert(f0.valid());
+    f0.get();
+    assert(!f0.valid());
+  }
+
+  {
+    // promise & future
+    promise<int> p;
+    future<int> f0 = p.get_future();
+    assert(!f0.is_ready());
+
+    p.set_value(13);
+    assert(f0.is_ready());
+    assert(f0.get() == 13);
+  }
+
+  {
+    // wait_for() and wait_until()
+    promise<int> p;
+    future<int> f0 = p.get_future();
+    assert(f0.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout);
+    assert(f0.wait_until(std::chrono::steady_clock::now()) == std::future_status::timeout);
+
+    std::thread t([&]
+    {
+      p.set_value(13);
+    });
+
+    assert(f0.wait_for(std::chrono::seconds(60)) == std::future_status::ready);
+    assert(f0.get() == 13);
+
+    t.join();
+
+    promise<void> p1;
+    shared_future<void> f1 = p1.get_future().share();
+    assert(f1.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+
+    p1.set_value();
+    assert(f1.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+  }
+
+  {
+    // a continuation of a std::future executes once its predecessor is ready
+    std::promise<int> p;
+    std::future<int> f0 = p.get_future();
+
+    std::future<int> f1 = future_traits<std::future<int>>::then(f0, [](int& x)
+    {
+      return x + 13;
+    });
+
+    p.set_value(7);
+    assert(f1.get() == 7 + 13);
+  }
+
+  {
+    // set_value from another thread
+    promise<void> p;
+    future<void> f0 = p.get_future();
+
+    std::thread t([&]
+    {
+      p.set_value();
+    });
+
+    f0.wait();
+    t.join();
+
+    f0.get();
+  }
+
+  {
+    // then() on a ready future executes immediately
+    future<int> f0 = future<int>::make_ready(13);
+
+    bool executed = false;
+    future<int> f1 = f0.then([&](int& x)
+    {
+      executed = true;
+      return x + 7;
+    });
+
+    assert(!f0.valid());
+    assert(executed);
+    assert(f1.get() == 13 + 7);
+  }
+
+  {
+    // continuations execute in the thread which fulfills the promise
+    promise<int> p;
+    future<int> f0 = p.get_future();
+
+    std::thread::id continuation_thread_id;
+    future<void> f1 = f0.then([&](int& x)
+    {
+      continuation_thread_id = std::this_thread::get_id();
+      assert(x == 13);
+    });
+
+    future<int> f2 = f1.then([]
+    {
+      return 7;
+    });
+
+    assert(!f2.is_ready());
+
+    std::thread t([&]
+    {
+      p.set_value(13);
+    });
+
+    auto setter_id = t.get_id();
+    t.join();
+
+    assert(f2.get() == 7);
+    assert(continuation_thread_id == setter_id);
+  }
+
+  {
+    // exceptions propagate through continuations
+    promise<int> p;
+    future<int> f0 = p.get_future();
+
+    bool executed = false;
+    future<int> f1 = f0.then([&](int& x)
+    {
+      executed = true;
+      return x;
+    });
+
+    p.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+
+    try
+    {
+      f1.get();
+      assert(false);
+    }
+    catch(std::runtime_error&) {}
+
+    assert(!executed);
+  }
+
+  {
+    // exceptions thrown by continuations are captured
+    future<void> f0 = future<void>::make_ready();
+
+    future<void> f1 = f0.then([]
+    {
+      throw std::runtime_error("error");
+    });
+
+    try
+    {
+      f1.get();
+      assert(false);
+    }
+    catch(std::runtime_error&) {}
+  }
+
+  {
+    // exceptions thrown by the successors of a continuation are not captured by that continuation
+    promise<int> p;
+    future<int> f0 = p.get_future();
+
+    shared_future<int> f1 = f0.then([](int& x)
+    {
+      return x + 1;
+    }).share();
+
+    detail::invoke_when_ready(f1, []
+    {
+      throw std::runtime_error("error");
+    });
+
+    try
+    {
+      p.set_value(13);
+      assert(false);
+    }
+    catch(std::runtime_error&) {}
+
+    assert(f1.is_ready());
+    assert(f1.get() == 14);
+  }
+
+  {
+    // broken promise
+    future<int> f0;
+
+    {
+      promise<int> p;
+      f0 = p.get_future();
+    }
+
+    try
+    {
+      f0.get();
+      assert(false);
+    }
+    catch(std::future_error& e)
+    {
+      assert(e.code() == std::future_errc::broken_promise);
+    }
+  }
+
+  {
+    // shared_future
+    promise<int> p;
+    shared_future<int> f0 = p.get_future().share();
+    shared_future<int> f1 = f0;
+
+    std::vector<future<int>> continuations;
+    for(int i = 0; i < 10; ++i)
+    {
+      continuations.push_back(f1.then([=](int& x)
+      {
+        return x + i;
+      }));
+    }
+
+    assert(f0.valid());
+    assert(f1.valid());
+
+    p.set_value(13);
+
+    assert(f0.get() == 13);
+    assert(f1.get() == 13);
+
+    for(int i = 0; i < 10; ++i)
+    {
+      assert(continuations[i].get() == 13 + i);
+    }
+  }
+
+  {
+    // then() with an executor
+    promise<int> p;
+    future<int> f0 = p.get_future();
+
+    parallel_executor exec;
+    auto f1 = f0.then(exec, [](int& x)
+    {
+      return x + 7;
+    });
+
+    assert(!f0.valid());
+
+    p.set_value(13);
+
+    assert(f1.get() == 13 + 7);
+  }
+
+  {
+    // long chain of continuations
+    promise<int> p;
+    future<int> f = p.get_future();
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      f = f.then([](int& x)
+      {
+        return x + 1;
+      });
+    }
+
+    p.set_value(0);
+
+    assert(f.get() == 1000);
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,124 @@
+#include <agency/memory/detail/resource/pooled_arena_resource.hpp>
+#include <agency/memory/detail/resource/arena_resource.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <agency/memory/detail/resource/tiered_resource.hpp>
+#include <iostream>
+#include <cassert>
+#include <cstddef>
+
+
+void test_arena_buffer_pool()
+{
+  using namespace agency::detail;
+
+  arena_buffer_pool pool;
+
+  assert(arena_buffer_pool::buffer_size(1) == arena_buffer_pool::min_buffer_size);
+  assert(arena_buffer_pool::buffer_size(1024) == 1024);
+  assert(arena_buffer_pool::buffer_size(1025) == 2048);
+
+  void* buffer = pool.acquire(3000);
+  assert(buffer);
+
+  // test that a released buffer is reused by an acquisition of the same size class
+  pool.release(buffer, 3000);
+  assert(pool.acquire(4096) == buffer);
+
+  // test that a buffer of a different size class is not reused
+  void* other_buffer = pool.acquire(1024);
+  assert(other_buffer != buffer);
+
+  pool.release(buffer, 4096);
+  pool.release(other_buffer, 1024);
+}
+
+
+void test_pooled_arena_resource()
+{
+  using namespace agency::detail;
+
+  {
+    // test that a default-constructed resource has no buffer
+
+    pooled_arena_resource resource;
+
+    assert(resource.size() == 0);
+    assert(resource.allocate(1) == nullptr);
+  }
+
+  void* first_allocation = nullptr;
+
+  {
+    pooled_arena_resource resource(3000);
+
+    assert(resource.size() == arena_buffer_pool::buffer_size(3000));
+
+    void* ptr1 = resource.allocate(1000);
+    void* ptr2 = resource.allocate(2000);
+
+    assert(ptr1 && ptr2);
+    assert(resource.owns(ptr1, 1000));
+    assert(resource.owns(ptr2, 2000));
+
+    int on_the_stack = 0;
+    assert(!resource.owns(&on_the_stack, sizeof(int)));
+
+    // test that the arena is exhausted
+    assert(resource.allocate(resource.size()) == nullptr);
+
+    // test that deallocation of the most recent allocation reclaims its storage
+    resource.deallocate(ptr2, 2000);
+    assert(resource.allocate(2000) == ptr2);
+
+    first_allocation = ptr1;
+  }
+
+  {
+    // test that the buffer of the destroyed resource is reused
+
+    pooled_arena_resource resource(4000);
+
+    assert(resource.allocate(8) == first_allocation);
+  }
+}
+
+
+void test_tiered_pooled_arena_resource()
+{
+  using namespace agency::detail;
+
+  // test that the constructor of tiered_resource forwards its argument to the tier which accepts it
+  using resource_type = tiered_resource<
+    tiered_resource<arena_resource<64>, pooled_arena_resource>,
+    malloc_resource
+  >;
+
+  resource_type resource(2048);
+
+  void* small = resource.allocate(16);
+  void* medium = resource.allocate(1024);
+  void* large = resource.allocate(1 << 20);
+
+  assert(small && medium && large);
+
+  resource.deallocate(large, 1 << 20);
+  resource.deallocate(medium, 1024);
+  resource.deallocate(small, 16);
+
+  // test that the reclaimed storage is reused
+  assert(resource.allocate(16) == small);
+  assert(resource.allocate(1024) == medium);
+}
+
+
+int main()
+{
+  test_arena_buffer_pool();
+  test_pooled_arena_resource();
+  test_tiered_pooled_arena_resource();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
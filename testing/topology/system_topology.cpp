@@ -0,0 +1,137 @@
+#include <agency/topology.hpp>
+#include <agency/execution/executor/customization_points.hpp>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+
+int main()
+{
+  using namespace agency;
+
+  const topology& t = system_topology();
+
+  {
+    // test that every cpu belongs to exactly one core, socket, and NUMA node
+
+    assert(t.sockets().size() > 0);
+    assert(t.numa_nodes().size() > 0);
+    assert(t.cores().size() > 0);
+    assert(t.num_cpus() >= t.cores().size());
+
+    std::vector<int> cpus_of_cores;
+    size_t num_cores_of_sockets = 0;
+    size_t num_cores_of_nodes = 0;
+
+    for(const auto& core : t.cores())
+    {
+      assert(!core.cpus.empty());
+      assert(core.socket < t.sockets().size());
+      assert(core.numa_node < t.numa_nodes().size());
+
+      cpus_of_cores.insert(cpus_of_cores.end(), core.cpus.begin(), core.cpus.end());
+    }
+
+    for(const auto& socket : t.sockets())
+    {
+      num_cores_of_sockets += socket.cores.size();
+    }
+
+    std::vector<int> cpus_of_nodes;
+    for(const auto& node : t.numa_nodes())
+    {
+      num_cores_of_nodes += node.cores.size();
+
+      cpus_of_nodes.insert(cpus_of_nodes.end(), node.cpus.begin(), node.cpus.end());
+    }
+
+    std::sort(cpus_of_cores.begin(), cpus_of_cores.end());
+    std::sort(cpus_of_nodes.begin(), cpus_of_nodes.end());
+
+    assert(cpus_of_cores == cpus_of_nodes);
+    assert(num_cores_of_sockets == t.cores().size());
+    assert(num_cores_of_nodes == t.cores().size());
+  }
+
+  {
+    // test caches
+
+    for(const auto& cache : t.caches())
+    {
+      assert(cache.level > 0);
+      assert(!cache.cpus.empty());
+    }
+
+    assert(t.cache_line_size() > 0);
+    assert(t.cache_size(0) == 0);
+  }
+
+  {
+    // test a topology described by hand
+    // one socket with two cores of two SMT siblings each, and a shared L2 cache
+
+    topology::core core0{0, 0, {0,2}};
+    topology::core core1{0, 0, {1,3}};
+
+    topology::socket socket{{0,1}};
+    topology::numa_node node{{0,1,2,3}, {0,1}};
+
+    topology::cache l1_0{1, "Data", 32 * 1024, 64, {0,2}};
+    topology::cache l1i_0{1, "Instruction", 32 * 1024, 64, {0,2}};
+    topology::cache l2{2, "Unified", 1024 * 1024, 128, {0,1,2,3}};
+
+    topology t({socket}, {node}, {core0, core1}, {l1_0, l1i_0, l2});
+
+    assert(t.num_cpus() == 4);
+    assert(t.cache_size(1) == 32 * 1024);
+    assert(t.cache_size(2) == 1024 * 1024);
+    assert(t.cache_size(3) == 0);
+    assert(t.cache_line_size() == 64);
+  }
+
+  {
+    // test make_topology_executor()
+
+    topology_executor exec = make_topology_executor();
+
+    assert(exec.size() == t.numa_nodes().size());
+
+    auto shape = exec.unit_shape();
+
+    assert(agency::get<0>(shape) == t.numa_nodes().size());
+    assert(agency::get<1>(shape) == std::max<size_t>(1, t.numa_nodes()[0].cores.size()));
+
+    // each agent records which node it executed on
+
+    using index_type = executor_index_t<topology_executor>;
+
+    auto predecessor = make_ready_future<void>(exec);
+
+    auto f = exec.bulk_then_execute(
+      [](index_type idx, std::vector<std::vector<int>>& visited, int&, int&)
+      {
+        visited[agency::get<0>(idx)][agency::get<1>(idx)] += 1;
+      },
+      shape,
+      predecessor,
+      [=]{ return std::vector<std::vector<int>>(agency::get<0>(shape), std::vector<int>(agency::get<1>(shape))); }, // results
+      []{ return 0; }, // outer_shared_arg
+      []{ return 0; }  // inner_shared_arg
+    );
+
+    auto visited = f.get();
+
+    for(const auto& node : visited)
+    {
+      for(int v : node)
+      {
+        assert(v == 1);
+      }
+    }
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}